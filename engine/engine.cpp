@@ -10,9 +10,12 @@
 #include <stdint.h>
 
 #include <freetype/ftdriver.h>
+#include <freetype/ftfntfmt.h>
 #include <freetype/ftlcdfil.h>
 #include <freetype/ftmm.h>
 #include <freetype/ftmodapi.h>
+#include <freetype/tttables.h>
+#include <freetype/tttags.h>
 
 
 /////////////////////////////////////////////////////////////////////////////
@@ -119,7 +122,8 @@ faceRequester(FTC_FaceID ftcFaceID,
 /////////////////////////////////////////////////////////////////////////////
 
 Engine::Engine()
-: fontFileManager_(this)
+: fontFileManager_(this),
+  fontFallback_(this)
 {
   ftSize_ = NULL;
   ftFallbackFace_ = NULL;
@@ -134,6 +138,31 @@ Engine::Engine()
     // XXX error handling
   }
 
+  // Sizes are created and destroyed all the time by the cache manager;
+  // let the TrueType driver restore the state after the CVT program
+  // instead of running it for every new size.
+  FT_Bool prepCache = true;
+  FT_Property_Set(library_,
+                  "truetype",
+                  "prep-cache",
+                  &prepCache);
+
+  // Likewise, keep the decrypted charstrings of CID-keyed fonts instead of
+  // reading and decrypting them again on every glyph load.
+  FT_Bool charstringCache = true;
+  FT_Property_Set(library_,
+                  "t1cid",
+                  "charstring-cache",
+                  &charstringCache);
+
+  // Keep FreeType's instruction limit unless the user lowers it.
+  FT_ULong maxOpcodes;
+  if (!FT_Property_Get(library_,
+                       "truetype",
+                       "max-runnable-opcodes",
+                       &maxOpcodes))
+    glyphOpcodeBudget_ = defaultGlyphOpcodeBudget_ = maxOpcodes;
+
   error = FTC_Manager_New(library_, 0, 0, 0,
                           faceRequester, this, &cacheManager_);
   if (error)
@@ -167,6 +196,7 @@ Engine::Engine()
 
 Engine::~Engine()
 {
+  fontFallback_.clear();
   FTC_Manager_Done(cacheManager_);
   FT_Done_FreeType(library_);
 }
@@ -178,6 +208,8 @@ Engine::withFace(FaceID id,
                  Func func)
 {
   FT_Face face;
+  cacheDirty_ = true; // Other faces might evict the current one.
+
   // Search triplet (fontIndex, faceIndex, namedInstanceIndex).
   auto numId = reinterpret_cast<FTC_FaceID>(faceIDMap_.value(id));
   if (numId)
@@ -359,17 +391,15 @@ Engine::loadFont(int fontIndex,
     else
       fontType_ = FontType_Other;
 
-    curCharMaps_.clear();
-    curCharMaps_.reserve(ftFallbackFace_->num_charmaps);
-    for (int i = 0; i < ftFallbackFace_->num_charmaps; i++)
-      curCharMaps_.emplace_back(i, ftFallbackFace_->charmaps[i]);
-
-    SFNTName::get(this, curSFNTNames_);
-    loadPaletteInfos();
-    curMMGXState_ = MMGXAxisInfo::get(this, curMMGXAxes_);
+    loadFaceInfo();
   }
 
   curNumGlyphs_ = numGlyphs;
+
+  // The load flags depend on the face.
+  settingsDirty_ = true;
+  cacheDirty_ = !ftSize_;
+
   return numGlyphs;
 }
 
@@ -381,8 +411,15 @@ Engine::reloadFont()
   palette_ = NULL;
   if (!scaler_.face_id)
     return;
+  if (!cacheDirty_)
+  {
+    reloadStatistics_.skippedReloads++;
+    return;
+  }
+  reloadStatistics_.reloads++;
   imageType_.face_id = scaler_.face_id;
 
+  auto oldFace = ftFallbackFace_;
   if (FTC_Manager_LookupFace(cacheManager_,
                              scaler_.face_id,
                              &ftFallbackFace_))
@@ -393,6 +430,14 @@ Engine::reloadFont()
   }
   if (FTC_Manager_LookupSize(cacheManager_, &scaler_, &ftSize_))
     ftSize_ = NULL; // Good font, bad size.
+  cacheDirty_ = !ftSize_; // Retry next time if failed.
+
+  if (ftFallbackFace_ != oldFace)
+  {
+    // Recompute the face-dependent load flags.
+    settingsDirty_ = true;
+    update();
+  }
 }
 
 
@@ -435,10 +480,26 @@ Engine::removeFont(int fontIndex,
 
     auto ftcFaceID = reinterpret_cast<FTC_FaceID>(iter.value());
     FTC_Manager_RemoveFaceID(cacheManager_, ftcFaceID);
+    preparedSize_ = NULL; // The face's sizes are gone.
+    faceInfoCache_.remove(iter.value()); // The file may have changed.
+    for (auto it = rejectedGlyphs_.begin(); it != rejectedGlyphs_.end();)
+      if (std::get<0>(it.key()) == iter.value())
+        it = rejectedGlyphs_.erase(it);
+      else
+        ++it;
+    for (auto it = rejectedSizes_.begin(); it != rejectedSizes_.end();)
+      if (std::get<0>(it.key()) == iter.value())
+        it = rejectedSizes_.erase(it);
+      else
+        ++it;
+    cacheDirty_ = true;
 
     iter = faceIDMap_.erase(iter);
   }
 
+  // Font indices may change, and the file may have been modified.
+  fontFallback_.clear();
+
   if (closeFile)
     fontFileManager_.remove(fontIndex);
 }
@@ -619,6 +680,29 @@ Engine::glyphName(int index)
 }
 
 
+int
+Engine::glyphIndexFromName(QString const& name)
+{
+  if (name.isEmpty())
+    return -1;
+
+  reloadFont();
+  if (!ftFallbackFace_ || !FT_HAS_GLYPH_NAMES(ftFallbackFace_))
+    return -1;
+
+  // FreeType builds a name-to-index hash on the first call, so repeated
+  // lookups are cheap.
+  auto nameBytes = name.toLatin1();
+  auto index = FT_Get_Name_Index(ftFallbackFace_, nameBytes.constData());
+
+  // Index 0 is returned for both `.notdef` and unknown names.
+  if (index == 0 && glyphName(0) != name)
+    return -1;
+
+  return static_cast<int>(index);
+}
+
+
 QString
 Engine::dynamicLibraryVersion()
 {
@@ -646,19 +730,26 @@ Engine::loadGlyph(int glyphIndex)
   if (glyphIndex < 0)
     throw std::runtime_error("Invalid glyph index");
 
-  if (curNumGlyphs_ <= 0)
+  if (curNumGlyphs_ <= 0 || glyphRejected(glyphIndex))
     return NULL;
 
   FT_Glyph glyph;
 
   // The `scaler` object is set up by the
   // `update` and `loadFont` methods.
-  if (FTC_ImageCache_LookupScaler(imageCache_,
-                                  &scaler_,
-                                  loadFlags_,
-                                  static_cast<unsigned int>(glyphIndex),
-                                  &glyph,
-                                  NULL))
+  if (!prepareSize(&scaler_, loadFlags_, glyphIndex))
+    return NULL;
+  auto abortedRuns = abortedBytecodeRuns();
+  QElapsedTimer timer;
+  timer.start();
+  auto error = FTC_ImageCache_LookupScaler(
+                 imageCache_,
+                 &scaler_,
+                 loadFlags_,
+                 static_cast<unsigned int>(glyphIndex),
+                 &glyph,
+                 NULL);
+  if (!checkGlyphLoad(glyphIndex, timer, abortedRuns, error) || error)
   {
     // XXX error handling?
     return NULL;
@@ -672,40 +763,261 @@ int
 Engine::loadGlyphIntoSlotWithoutCache(int glyphIndex,
                                       bool noScale)
 {
+  if (glyphRejected(glyphIndex))
+    return FT_Err_Execution_Too_Long;
+
   auto flags = static_cast<int>(loadFlags_);
   if (noScale)
     flags |= FT_LOAD_NO_SCALE;
-  return FT_Load_Glyph(ftSize_->face, glyphIndex, flags);
+
+  if (!prepareSize(&scaler_, loadFlags_, glyphIndex))
+    return FT_Err_Execution_Too_Long;
+  auto abortedRuns = abortedBytecodeRuns();
+  QElapsedTimer timer;
+  timer.start();
+  auto error = FT_Load_Glyph(ftSize_->face, glyphIndex, flags);
+  if (!checkGlyphLoad(glyphIndex, timer, abortedRuns, error) && !error)
+    return FT_Err_Execution_Too_Long;
+  return error;
 }
 
 
 // When continuous rendering, we don't need to call `update`.
-// This is currently unused since the cache API doesn't support obtaining
-// glyph metrics.  See `StringRenderer::loadSingleContext`.
+// String rendering doesn't use this since the cache API doesn't support
+// obtaining glyph metrics (see `StringRenderer::loadSingleContext`); it
+// loads the layers of color glyphs, though.
 FT_Glyph
 Engine::loadGlyphWithoutUpdate(int glyphIndex,
                                FTC_Node* outNode,
                                bool forceRender)
 {
+  if (glyphRejected(glyphIndex))
+    return NULL;
+
   FT_Glyph glyph;
   auto oldFlags = imageType_.flags;
   if (forceRender)
     imageType_.flags |= FT_LOAD_RENDER;
-  if (FTC_ImageCache_Lookup(imageCache_,
-                            &imageType_,
-                            glyphIndex,
-                            &glyph,
-                            outNode))
+  invalidateCurrentSize(); // `imageType_` uses pixel sizes.
+  FTC_ScalerRec scaler = { imageType_.face_id,
+                           imageType_.width,
+                           imageType_.height,
+                           1, 0, 0 };
+  if (!prepareSize(&scaler,
+                   static_cast<unsigned long>(imageType_.flags),
+                   glyphIndex))
+  {
+    imageType_.flags = oldFlags;
+    return NULL;
+  }
+  auto abortedRuns = abortedBytecodeRuns();
+  QElapsedTimer timer;
+  timer.start();
+  auto error = FTC_ImageCache_Lookup(imageCache_,
+                                     &imageType_,
+                                     glyphIndex,
+                                     &glyph,
+                                     outNode);
+  imageType_.flags = oldFlags;
+  if (!checkGlyphLoad(glyphIndex, timer, abortedRuns, error) || error)
   {
     // XXX error handling?
     return NULL;
   }
 
-  imageType_.flags = oldFlags;
   return glyph;
 }
 
 
+FTC_SBit
+Engine::loadSBitWithoutUpdate(int glyphIndex)
+{
+  if (glyphRejected(glyphIndex))
+    return NULL;
+
+  // The cache derives the render mode from the load target.  If hinting is
+  // on, the target already matches `renderMode_`; otherwise it has no
+  // effect on the outline.
+  auto flags = loadFlags_ & ~static_cast<unsigned long>(FT_LOAD_TARGET_(0xF));
+  flags |= FT_LOAD_TARGET_(renderMode_);
+
+  FTC_SBit sbit;
+  if (!prepareSize(&scaler_, flags, glyphIndex))
+    return NULL;
+  auto abortedRuns = abortedBytecodeRuns();
+  QElapsedTimer timer;
+  timer.start();
+  auto error = FTC_SBitCache_LookupScaler(sbitsCache_,
+                                          &scaler_,
+                                          flags,
+                                          static_cast<unsigned int>(
+                                            glyphIndex),
+                                          &sbit,
+                                          NULL);
+  if (!checkGlyphLoad(glyphIndex, timer, abortedRuns, error) || error)
+    return NULL;
+
+  // Glyphs that failed to load or are too large are stored as empty
+  // bitmaps with a width of 255.
+  if (!sbit->buffer && sbit->width == 255)
+    return NULL;
+
+  return sbit;
+}
+
+
+QString
+Engine::glyphError(int glyphIndex)
+{
+  return rejectedGlyphs_.value(glyphKey(glyphIndex));
+}
+
+
+Engine::GlyphKey
+Engine::glyphKey(int glyphIndex)
+{
+  return std::make_tuple(reinterpret_cast<FTC_IDType>(scaler_.face_id),
+                         scaler_.width,
+                         scaler_.height,
+                         scaler_.x_res,
+                         scaler_.y_res,
+                         loadFlags_,
+                         glyphIndex);
+}
+
+
+bool
+Engine::prepareSize(FTC_Scaler scaler,
+                    unsigned long loadFlags,
+                    int glyphIndex)
+{
+  loadFlags &= ~static_cast<unsigned long>(FT_LOAD_RENDER);
+  auto key = std::make_tuple(reinterpret_cast<FTC_IDType>(scaler->face_id),
+                             scaler->width,
+                             scaler->height,
+                             scaler->pixel,
+                             scaler->x_res,
+                             scaler->y_res,
+                             loadFlags);
+  if (!rejectedSizes_.isEmpty())
+  {
+    auto it = rejectedSizes_.find(key);
+    if (it != rejectedSizes_.end())
+    {
+      rejectedGlyphs_.insert(glyphKey(glyphIndex), it.value());
+      return false;
+    }
+  }
+
+  // Creating a size may already run bytecode (the TrueType font program).
+  auto abortedRuns = abortedBytecodeRuns();
+  QElapsedTimer timer;
+  timer.start();
+  FT_Size size;
+  auto error = FTC_Manager_LookupSize(cacheManager_, scaler, &size);
+  if (error)
+    size = NULL;
+  else
+  {
+    // The address of a size flushed by the cache manager may be reused for
+    // another one, hence the key.  The pointer catches the re-creation of a
+    // flushed size with the same key.
+    if (size == preparedSize_ && key == preparedSizeKey_)
+      return true;
+    if (needsSizeWarmUp(size->face, loadFlags))
+      error = FT_Load_Glyph(size->face, 0, static_cast<FT_Int32>(loadFlags));
+  }
+
+  preparedSize_ = size;
+  preparedSizeKey_ = key;
+
+  auto reason = budgetViolation(true, timer, abortedRuns, error);
+  if (reason.isEmpty())
+    return true;
+
+  rejectedSizes_.insert(key, reason);
+  rejectedGlyphs_.insert(glyphKey(glyphIndex), reason);
+  return false;
+}
+
+
+bool
+Engine::needsSizeWarmUp(FT_Face face,
+                        unsigned long loadFlags)
+{
+  // Only the TrueType bytecode interpreter does noticeable work per size;
+  // the auto-hinter's per-size setup is cheap.
+  if (loadFlags & (FT_LOAD_NO_HINTING | FT_LOAD_FORCE_AUTOHINT)
+      || qstrcmp(FT_Get_Font_Format(face), "TrueType"))
+    return false;
+
+  FT_ULong length = 0;
+  return !FT_Load_Sfnt_Table(face, TTAG_prep, 0, NULL, &length)
+         || !FT_Load_Sfnt_Table(face, TTAG_fpgm, 0, NULL, &length);
+}
+
+
+bool
+Engine::glyphRejected(int glyphIndex)
+{
+  return !rejectedGlyphs_.isEmpty()
+         && rejectedGlyphs_.contains(glyphKey(glyphIndex));
+}
+
+
+bool
+Engine::checkGlyphLoad(int glyphIndex,
+                       QElapsedTimer const& timer,
+                       unsigned long abortedRuns,
+                       FT_Error error)
+{
+  auto reason = budgetViolation(false, timer, abortedRuns, error);
+  if (reason.isEmpty())
+    return true;
+
+  rejectedGlyphs_.insert(glyphKey(glyphIndex), reason);
+  return false;
+}
+
+
+QString
+Engine::budgetViolation(bool sizeSetup,
+                        QElapsedTimer const& timer,
+                        unsigned long abortedRuns,
+                        FT_Error error)
+{
+  // Cache hits are far below any sensible budget.
+  auto elapsed = timer.elapsed();
+
+  // Unless loading pedantically, FreeType returns glyphs whose bytecode
+  // was aborted as if nothing happened, just partially hinted.
+  if (abortedBytecodeRuns() != abortedRuns
+      || FT_ERROR_BASE(error) == FT_Err_Execution_Too_Long)
+    return QString(sizeSetup
+                     ? "Glyph skipped: bytecode of the size setup exceeded"
+                       " %1 instructions"
+                     : "Glyph skipped: bytecode exceeded %1 instructions")
+             .arg(glyphOpcodeBudget_);
+  if (glyphTimeBudget_ > 0 && elapsed > glyphTimeBudget_)
+    return QString(sizeSetup
+                     ? "Glyph skipped: setting up the size took %1 ms"
+                       " (budget: %2 ms)"
+                     : "Glyph skipped: loading took %1 ms (budget: %2 ms)")
+             .arg(elapsed)
+             .arg(glyphTimeBudget_);
+  return QString();
+}
+
+
+unsigned long
+Engine::abortedBytecodeRuns()
+{
+  FT_ULong count = 0; // If FreeType doesn't have the property.
+  FT_Property_Get(library_, "truetype", "aborted-runs", &count);
+  return count;
+}
+
+
 FT_Size_Metrics const&
 Engine::currentFontMetrics()
 {
@@ -744,24 +1056,25 @@ Engine::openFonts(QStringList const& fontFileNames)
 void
 Engine::setSizeByPixel(double pixelSize)
 {
-  this->pixelSize_ = pixelSize;
-  pointSize_ = pixelSize * 72.0 / dpi_;
-  usingPixelSize_ = true;
+  setSetting(pixelSize_, pixelSize);
+  setSetting(pointSize_, pixelSize * 72.0 / dpi_);
+  setSetting(usingPixelSize_, true);
 }
 
 
 void
 Engine::setSizeByPoint(double pointSize)
 {
-  this->pointSize_ = pointSize;
-  pixelSize_ = pointSize * dpi_ / 72.0;
-  usingPixelSize_ = false;
+  setSetting(pointSize_, pointSize);
+  setSetting(pixelSize_, pointSize * dpi_ / 72.0);
+  setSetting(usingPixelSize_, false);
 }
 
 
 void
 Engine::setLcdFilter(FT_LcdFilter filter)
 {
+  lcdFilter_ = filter;
   FT_Library_SetLcdFilter(library_, filter);
 }
 
@@ -814,6 +1127,95 @@ Engine::setStemDarkening(bool darkening)
 }
 
 
+void
+Engine::setComponentCache(bool enabled)
+{
+  // Cached components are not re-hinted in the context of their composite
+  // glyph and thus may render differently; this is therefore off unless
+  // explicitly requested.  FreeType versions without this property simply
+  // return an error, which we ignore.
+  FT_Bool componentCache = enabled;
+  FT_Property_Set(library_,
+                  "truetype",
+                  "component-cache",
+                  &componentCache);
+  resetCache();
+}
+
+
+void
+Engine::applyDriverProperties(FT_Library library)
+{
+  // Properties not supported by a module are silently skipped.
+  FT_Bool componentCache;
+  if (!FT_Property_Get(library_, "truetype", "component-cache",
+                       &componentCache))
+    FT_Property_Set(library, "truetype", "component-cache",
+                    &componentCache);
+
+  FT_Bool prepCache;
+  if (!FT_Property_Get(library_, "truetype", "prep-cache", &prepCache))
+    FT_Property_Set(library, "truetype", "prep-cache", &prepCache);
+
+  FT_ULong maxOpcodes;
+  if (!FT_Property_Get(library_, "truetype", "max-runnable-opcodes",
+                       &maxOpcodes))
+    FT_Property_Set(library, "truetype", "max-runnable-opcodes",
+                    &maxOpcodes);
+
+  FT_Bool charstringCache;
+  if (!FT_Property_Get(library_, "t1cid", "charstring-cache",
+                       &charstringCache))
+    FT_Property_Set(library, "t1cid", "charstring-cache", &charstringCache);
+
+  FT_UInt version;
+  if (!FT_Property_Get(library_, "truetype", "interpreter-version",
+                       &version))
+    FT_Property_Set(library, "truetype", "interpreter-version", &version);
+
+  for (auto module : { "cff", "type1", "t1cid" })
+  {
+    FT_UInt hintingEngine;
+    if (!FT_Property_Get(library_, module, "hinting-engine", &hintingEngine))
+      FT_Property_Set(library, module, "hinting-engine", &hintingEngine);
+  }
+
+  for (auto module : { "cff", "autofitter", "type1", "t1cid" })
+  {
+    FT_Bool noDarkening;
+    if (!FT_Property_Get(library_, module, "no-stem-darkening",
+                         &noDarkening))
+      FT_Property_Set(library, module, "no-stem-darkening", &noDarkening);
+  }
+
+  FT_Library_SetLcdFilter(library, lcdFilter_);
+}
+
+
+void
+Engine::setGlyphBudgets(int timeBudget,
+                        unsigned long opcodeBudget)
+{
+  glyphTimeBudget_ = timeBudget;
+  rejectedGlyphs_.clear();
+  rejectedSizes_.clear();
+
+  if (opcodeBudget == glyphOpcodeBudget_)
+    return;
+
+  FT_ULong maxOpcodes = opcodeBudget;
+  FT_Error error = FT_Property_Set(library_,
+                                   "truetype",
+                                   "max-runnable-opcodes",
+                                   &maxOpcodes);
+  if (!error)
+  {
+    glyphOpcodeBudget_ = opcodeBudget;
+    resetCache(); // Hinting results may depend on the limit.
+  }
+}
+
+
 void
 Engine::applyMMGXDesignCoords(FT_Fixed* coords,
                               size_t count)
@@ -831,6 +1233,15 @@ Engine::applyMMGXDesignCoords(FT_Fixed* coords,
 void
 Engine::update()
 {
+  if (!settingsDirty_)
+  {
+    reloadStatistics_.skippedUpdates++;
+    return;
+  }
+  settingsDirty_ = false;
+  reloadStatistics_.updates++;
+  auto oldScaler = scaler_;
+
   loadFlags_ = FT_LOAD_DEFAULT;
 
   if (!embeddedBitmap_)
@@ -877,6 +1288,12 @@ Engine::update()
   imageType_.width = static_cast<unsigned int>(pixelSize_);
   imageType_.height = static_cast<unsigned int>(pixelSize_);
   imageType_.flags = static_cast<int>(loadFlags_);
+
+  if (scaler_.width != oldScaler.width
+      || scaler_.height != oldScaler.height
+      || scaler_.x_res != oldScaler.x_res
+      || scaler_.y_res != oldScaler.y_res)
+    cacheDirty_ = true;
 }
 
 
@@ -885,9 +1302,14 @@ Engine::resetCache()
 {
   // Reset the cache.
   FTC_Manager_Reset(cacheManager_);
+  if (renderingEngine_)
+    renderingEngine_->clearColorGlyphCache();
+  fontFallback_.closeFaces(); // Driver properties might have changed.
   ftFallbackFace_ = NULL;
   ftSize_ = NULL;
+  preparedSize_ = NULL;
   palette_ = NULL;
+  cacheDirty_ = true;
 }
 
 
@@ -904,6 +1326,7 @@ Engine::loadDefaults()
       setTTInterpreterVersion(engineDefaults_.ttInterpreterVersionDefault);
   }
   setStemDarkening(false);
+  setComponentCache(false);
   applyMMGXDesignCoords(NULL, 0);
 
   setAntiAliasingEnabled(true);
@@ -1046,4 +1469,47 @@ Engine::loadPaletteInfos()
 }
 
 
+void
+Engine::loadFaceInfo()
+{
+  auto id = reinterpret_cast<FTC_IDType>(scaler_.face_id);
+  auto iter = faceInfoCache_.find(id);
+  if (iter != faceInfoCache_.end())
+  {
+    auto& info = iter.value();
+    curCharMaps_ = info.charMaps;
+    curSFNTNames_ = info.sfntNames;
+    curPaletteInfos_ = info.paletteInfos;
+    curMMGXState_ = info.mmgxState;
+    curMMGXAxes_ = info.mmgxAxes;
+
+    // The face object may have been recreated by the cache manager since;
+    // refresh everything pointing into it.
+    for (auto& charMap : curCharMaps_)
+      charMap.ptr = ftFallbackFace_->charmaps[charMap.index];
+    if (FT_Palette_Data_Get(ftFallbackFace_, &paletteData_))
+      paletteData_.num_palettes = 0;
+    return;
+  }
+
+  // This is the expensive part: `CharMapInfo` searches the maximum index
+  // of each charmap.
+  curCharMaps_.clear();
+  curCharMaps_.reserve(ftFallbackFace_->num_charmaps);
+  for (int i = 0; i < ftFallbackFace_->num_charmaps; i++)
+    curCharMaps_.emplace_back(i, ftFallbackFace_->charmaps[i]);
+
+  SFNTName::get(this, curSFNTNames_);
+  loadPaletteInfos();
+  curMMGXState_ = MMGXAxisInfo::get(this, curMMGXAxes_);
+
+  auto& info = faceInfoCache_[id];
+  info.charMaps = curCharMaps_;
+  info.sfntNames = curSFNTNames_;
+  info.paletteInfos = curPaletteInfos_;
+  info.mmgxState = curMMGXState_;
+  info.mmgxAxes = curMMGXAxes_;
+}
+
+
 // end of engine.cpp
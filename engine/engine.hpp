@@ -8,15 +8,20 @@
 
 #include "charmap.hpp"
 #include "fontinfo.hpp"
+#include "fontfallback.hpp"
 #include "fontfilemanager.hpp"
 #include "mmgx.hpp"
 #include "paletteinfo.hpp"
 #include "rendering.hpp"
+#include "renderscheduler.hpp"
+#include "renderworker.hpp"
 
 #include <memory>
+#include <tuple>
 #include <utility>
 #include <vector>
 
+#include <QElapsedTimer>
 #include <QString>
 #include <QMap>
 
@@ -88,9 +93,17 @@ public:
   FT_Glyph loadGlyphWithoutUpdate(int glyphIndex,
                                   FTC_Node* outNode = NULL,
                                   bool forceRender = false);
+  // Look up a glyph bitmap rendered with the current size, load flags, and
+  // render mode in the small bitmap cache.  Return NULL if the glyph can't
+  // be loaded or is too large for the cache (the bitmap must be smaller than
+  // 256 pixels in each direction).  The result is valid until the next
+  // cache operation.
+  FTC_SBit loadSBitWithoutUpdate(int glyphIndex);
 
   // Reload current triplet, but with updated settings, useful for updating
   // `ftSize_` and `ftFallbackFace_` only - more convenient than `loadFont`.
+  // This is a no-op if neither the settings nor the cache manager's state
+  // changed since the last call.
   void reloadFont();
   void loadPalette();
 
@@ -98,9 +111,23 @@ public:
   void removeFont(int fontIndex,
                   bool closeFile = true);
 
-  void update();
+  void update(); // Skipped if no setting changed since the last call.
   void resetCache();
   void loadDefaults();
+  // Call this after looking up sizes other than `scaler` with the cache
+  // manager: the current size might have been deactivated or flushed.
+  void invalidateCurrentSize() { cacheDirty_ = true; }
+
+  // How often `reloadFont` and `update` did their work, and how often they
+  // could be skipped.
+  struct ReloadStatistics
+  {
+    unsigned long reloads = 0;
+    unsigned long skippedReloads = 0;
+    unsigned long updates = 0;
+    unsigned long skippedUpdates = 0;
+  };
+  ReloadStatistics const& reloadStatistics() { return reloadStatistics_; }
 
   //////// Getters
 
@@ -108,8 +135,11 @@ public:
   FTC_Manager cacheManager() { return cacheManager_; }
   FTC_ImageCache imageCacheManager() { return imageCache_; }
   FontFileManager& fontFileManager() { return fontFileManager_; }
+  FontFallback& fontFallback() { return fontFallback_; }
   EngineDefaultValues& engineDefaults() { return engineDefaults_; }
   RenderingEngine* renderingEngine() { return renderingEngine_.get(); }
+  RenderScheduler* renderScheduler() { return &renderScheduler_; }
+  RenderWorkerPool* renderWorkers() { return &renderWorkers_; }
   QString dynamicLibraryVersion();
 
   int numberOfOpenedFonts();
@@ -140,6 +170,8 @@ public:
   std::vector<CharMapInfo>& currentFontCharMaps() { return curCharMaps_; }
 
   QString glyphName(int glyphIndex);
+  // Return -1 if there is no glyph with this name.
+  int glyphIndexFromName(QString const& name);
   long numberOfFaces(int fontIndex);
   int numberOfNamedInstances(int fontIndex,
                              long faceIndex);
@@ -171,6 +203,8 @@ public:
   int dpi() { return dpi_; }
   double pointSize() { return pointSize_; }
   FTC_ImageType imageType() { return &imageType_; }
+  FTC_Scaler scaler() { return &scaler_; }
+  unsigned long loadFlags() { return loadFlags_; }
   bool antiAliasingEnabled() { return antiAliasingEnabled_; }
   bool doHinting() { return doHinting_; }
   bool embeddedBitmapEnabled() { return embeddedBitmap_; }
@@ -182,11 +216,12 @@ public:
 
   //////// Setters (direct or indirect)
 
-  void setDPI(int d) { dpi_ = d; }
+  void setDPI(int d) { setSetting(dpi_, static_cast<unsigned>(d)); }
   void setSizeByPixel(double pixelSize);
   void setSizeByPoint(double pointSize);
-  void setHinting(bool hinting) { doHinting_ = hinting; }
-  void setAutoHinting(bool autoHinting) { doAutoHinting_ = autoHinting; }
+  void setHinting(bool hinting) { setSetting(doHinting_, hinting); }
+  void setAutoHinting(bool autoHinting)
+         { setSetting(doAutoHinting_, autoHinting); }
   void setHorizontalHinting(bool horHinting)
          { doHorizontalHinting_ = horHinting; }
   void setVerticalHinting(bool verticalHinting)
@@ -194,12 +229,15 @@ public:
   void setBlueZoneHinting(bool blueZoneHinting)
          { doBlueZoneHinting_ = blueZoneHinting; }
   void setShowSegments(bool showSegments) { showSegments_ = showSegments; }
-  void setAntiAliasingTarget(int target) { antiAliasingTarget_ = target; }
+  void setAntiAliasingTarget(int target)
+         { setSetting(antiAliasingTarget_, target); }
   void setRenderMode(int mode) { renderMode_ = mode; }
   void setAntiAliasingEnabled(bool enabled)
-         { antiAliasingEnabled_ = enabled; }
-  void setEmbeddedBitmapEnabled(bool enabled) { embeddedBitmap_ = enabled; }
-  void setUseColorLayer(bool colorLayer) { useColorLayer_ = colorLayer; }
+         { setSetting(antiAliasingEnabled_, enabled); }
+  void setEmbeddedBitmapEnabled(bool enabled)
+         { setSetting(embeddedBitmap_, enabled); }
+  void setUseColorLayer(bool colorLayer)
+         { setSetting(useColorLayer_, colorLayer); }
   void setPaletteIndex(int index) { paletteIndex_ = index; }
   void setLCDSubPixelPositioning(bool sp) { lcdSubPixelPositioning_ = sp; }
 
@@ -211,9 +249,30 @@ public:
   void setTTInterpreterVersion(int version);
 
   void setStemDarkening(bool darkening);
+  void setComponentCache(bool enabled);
+  // Copy the driver properties and the LCD filter set above to another
+  // library, e.g., one used by a worker thread.
+  void applyDriverProperties(FT_Library library);
   void applyMMGXDesignCoords(FT_Fixed* coords,
                              size_t count);
 
+  // Budgets against hostile fonts.  The opcode budget limits every run of
+  // the TrueType bytecode interpreter (FreeType's limit by default).  A
+  // glyph whose bytecode gets aborted or whose loading takes longer than
+  // the time budget (in milliseconds, for any font format) is rejected for
+  // the current face, size, and load flags, so that it isn't loaded again
+  // on every repaint.  Changing the budgets forgets rejected glyphs.
+  void setGlyphBudgets(int timeBudget,
+                       unsigned long opcodeBudget);
+  int glyphTimeBudget() { return glyphTimeBudget_; }
+  unsigned long glyphOpcodeBudget() { return glyphOpcodeBudget_; }
+  unsigned long defaultGlyphOpcodeBudget()
+                  { return defaultGlyphOpcodeBudget_; }
+  // Empty unless the glyph was rejected.
+  QString glyphError(int glyphIndex);
+
+  constexpr static int DefaultGlyphTimeBudget = 250;
+
   //////// Miscellaneous
 
   friend FT_Error faceRequester(FTC_FaceID,
@@ -227,6 +286,7 @@ private:
   QMap<FaceID, FTC_IDType> faceIDMap_;
 
   FontFileManager fontFileManager_;
+  FontFallback fontFallback_;
 
   // font info
   int curFontIndex_ = -1;
@@ -243,6 +303,40 @@ private:
   std::vector<MMGXAxisInfo> curMMGXAxes_;
   std::vector<SFNTName> curSFNTNames_;
 
+  // Font information that never changes for a face, computed when the face
+  // is loaded for the first time.  Switching back to a face copies it from
+  // here.
+  struct FaceInfo
+  {
+    std::vector<CharMapInfo> charMaps;
+    std::vector<PaletteInfo> paletteInfos;
+    MMGXState mmgxState = MMGXState::NoMMGX;
+    std::vector<MMGXAxisInfo> mmgxAxes;
+    std::vector<SFNTName> sfntNames;
+  };
+  QMap<FTC_IDType, FaceInfo> faceInfoCache_;
+
+  // (face ID, scaler width, height, x and y resolution, load flags, glyph
+  // index) -> reason of the rejection.
+  using GlyphKey = std::tuple<FTC_IDType,
+                              FT_UInt, FT_UInt, FT_UInt, FT_UInt,
+                              unsigned long,
+                              int>;
+  QMap<GlyphKey, QString> rejectedGlyphs_;
+  // (face ID, scaler width, height, pixel flag, x and y resolution, load
+  // flags) -> reason of the rejection, for `prepareSize`.
+  using SizeKey = std::tuple<FTC_IDType,
+                             FT_UInt, FT_UInt, FT_Int, FT_UInt, FT_UInt,
+                             unsigned long>;
+  QMap<SizeKey, QString> rejectedSizes_;
+  // The last size set up by `prepareSize`.
+  FT_Size preparedSize_ = NULL;
+  SizeKey preparedSizeKey_;
+  int glyphTimeBudget_ = DefaultGlyphTimeBudget;
+  // Set from FreeType's 'max-runnable-opcodes' property.
+  unsigned long defaultGlyphOpcodeBudget_ = 1000000;
+  unsigned long glyphOpcodeBudget_ = defaultGlyphOpcodeBudget_;
+
   // basic objects
   FT_Library library_ = NULL;
   FTC_Manager cacheManager_ = NULL;
@@ -262,6 +356,12 @@ private:
   FT_Palette_Data paletteData_ = {};
   FT_Color* palette_ = NULL;
 
+  // Dirty-state tracking: `update` has to recompute the load flags and the
+  // scaler, and `reloadFont` has to look up the face and size again.
+  bool settingsDirty_ = true;
+  bool cacheDirty_ = true;
+  ReloadStatistics reloadStatistics_;
+
   bool antiAliasingEnabled_ = true;
   bool usingPixelSize_ = false;
   double pointSize_ = 20;
@@ -280,13 +380,55 @@ private:
   int antiAliasingTarget_ = 0;
   bool lcdSubPixelPositioning_ = false;
   int renderMode_ = 0;
+  FT_LcdFilter lcdFilter_ = FT_LCD_FILTER_DEFAULT;
 
   unsigned long loadFlags_ = FT_LOAD_DEFAULT;
 
   std::unique_ptr<RenderingEngine> renderingEngine_;
+  // Destroyed after the scheduler, which waits for jobs using it.
+  RenderWorkerPool renderWorkers_;
+  RenderScheduler renderScheduler_;
 
   void queryEngine();
   void loadPaletteInfos();
+  void loadFaceInfo();
+
+  GlyphKey glyphKey(int glyphIndex);
+  // Hinting engines set up a size (e.g., run the TrueType CVT program)
+  // when the first glyph is loaded with it.  Do this beforehand by loading
+  // glyph 0 so that it isn't charged to that glyph; the setup has the same
+  // budgets as a glyph, though.  If it exceeds them, the size is rejected
+  // as a whole, and so is `glyphIndex`; return false then.
+  bool prepareSize(FTC_Scaler scaler,
+                   unsigned long loadFlags,
+                   int glyphIndex);
+  bool needsSizeWarmUp(FT_Face face,
+                       unsigned long loadFlags);
+  bool glyphRejected(int glyphIndex);
+  // Reject the glyph if loading it exceeded a budget; `abortedRuns` is
+  // the value of `abortedBytecodeRuns` before loading.
+  bool checkGlyphLoad(int glyphIndex,
+                      QElapsedTimer const& timer,
+                      unsigned long abortedRuns,
+                      FT_Error error);
+  // Return the reason of the rejection if a budget was exceeded, or an
+  // empty string.
+  QString budgetViolation(bool sizeSetup,
+                          QElapsedTimer const& timer,
+                          unsigned long abortedRuns,
+                          FT_Error error);
+  unsigned long abortedBytecodeRuns();
+
+  // For settings used by `update`.
+  template <class T>
+  void setSetting(T& field,
+                  T value)
+  {
+    if (field == value)
+      return;
+    field = value;
+    settingsDirty_ = true;
+  }
 
   // It is safe to put the implementation into the corresponding cpp file.
   template <class Func>
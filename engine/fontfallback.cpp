@@ -0,0 +1,171 @@
+// fontfallback.cpp
+
+// Copyright (C) 2022-2023 by
+// Charlie Jiang.
+
+#include "engine.hpp"
+#include "fontfallback.hpp"
+
+
+void
+CharCoverage::build(FT_Face face)
+{
+  pages_.clear();
+  if (!face->charmap || face->charmap->encoding != FT_ENCODING_UNICODE)
+    return;
+
+  FT_UInt index;
+  auto charCode = FT_Get_First_Char(face, &index);
+  while (index != 0 && charCode <= MaxCharCode)
+  {
+    auto pageIndex = charCode >> PageShift;
+    if (pageIndex >= pages_.size())
+      pages_.resize(pageIndex + 1);
+    if (!pages_[pageIndex])
+      pages_[pageIndex].reset(new std::bitset<PageSize>);
+    pages_[pageIndex]->set(charCode & (PageSize - 1));
+
+    charCode = FT_Get_Next_Char(face, charCode, &index);
+  }
+}
+
+
+FontFallback::FontFallback(Engine* engine)
+: engine_(engine)
+{
+}
+
+
+FontFallback::~FontFallback()
+{
+  clear();
+}
+
+
+int
+FontFallback::findFont(unsigned long charCode,
+                       int excludeFontIndex,
+                       unsigned* outGlyphIndex)
+{
+  auto count = engine_->numberOfOpenedFonts();
+  if (entries_.size() < static_cast<size_t>(count))
+    entries_.resize(count);
+
+  for (int i = 0; i < count; i++)
+  {
+    if (i == excludeFontIndex)
+      continue;
+
+    auto& entry = entries_[i];
+    if (!entry.coverageValid)
+    {
+      auto face = openFace(i);
+      if (face)
+        entry.coverage.build(face);
+      entry.coverageValid = true;
+    }
+    if (!entry.coverage.contains(charCode))
+      continue;
+
+    auto face = openFace(i);
+    if (!face)
+      continue;
+    auto glyphIndex = FT_Get_Char_Index(face, charCode);
+    if (!glyphIndex)
+      continue;
+
+    *outGlyphIndex = glyphIndex;
+    return i;
+  }
+
+  return -1;
+}
+
+
+FT_GlyphSlot
+FontFallback::loadGlyph(int fontIndex,
+                        unsigned glyphIndex)
+{
+  auto face = openFace(fontIndex);
+  if (!face)
+    return NULL;
+
+  // Same as the cache manager does for the current font.
+  auto& entry = entries_[fontIndex];
+  auto scaler = engine_->scaler();
+  if (entry.size.width != scaler->width
+      || entry.size.height != scaler->height
+      || entry.size.pixel != scaler->pixel
+      || entry.size.x_res != scaler->x_res
+      || entry.size.y_res != scaler->y_res)
+  {
+    FT_Error error;
+    if (scaler->pixel)
+      error = FT_Set_Pixel_Sizes(face, scaler->width, scaler->height);
+    else
+      error = FT_Set_Char_Size(face,
+                               static_cast<FT_F26Dot6>(scaler->width),
+                               static_cast<FT_F26Dot6>(scaler->height),
+                               scaler->x_res,
+                               scaler->y_res);
+    if (error)
+    {
+      entry.size = {};
+      return NULL;
+    }
+    entry.size = *scaler;
+  }
+
+  if (FT_Load_Glyph(face,
+                    glyphIndex,
+                    static_cast<FT_Int32>(engine_->loadFlags())))
+    return NULL;
+  return face->glyph;
+}
+
+
+void
+FontFallback::closeFaces()
+{
+  for (auto& entry : entries_)
+  {
+    if (entry.face)
+      FT_Done_Face(entry.face);
+    entry.face = NULL;
+    entry.size = {};
+  }
+}
+
+
+void
+FontFallback::clear()
+{
+  closeFaces();
+  entries_.clear();
+}
+
+
+FT_Face
+FontFallback::openFace(int fontIndex)
+{
+  if (fontIndex < 0 || fontIndex >= engine_->numberOfOpenedFonts())
+    return NULL;
+  if (entries_.size() <= static_cast<size_t>(fontIndex))
+    entries_.resize(fontIndex + 1);
+
+  auto& entry = entries_[fontIndex];
+  if (entry.face)
+    return entry.face;
+
+  auto& info = engine_->fontFileManager()[fontIndex];
+  if (FT_New_Face(engine_->ftLibrary(),
+                  qPrintable(info.filePath()),
+                  0,
+                  &entry.face))
+    entry.face = NULL;
+
+  return entry.face;
+}
+
+
+// end of fontfallback.cpp
@@ -0,0 +1,91 @@
+// fontfallback.hpp
+
+// Copyright (C) 2022-2023 by
+// Charlie Jiang.
+
+#pragma once
+
+#include <bitset>
+#include <memory>
+#include <vector>
+
+#include <freetype/freetype.h>
+#include <freetype/ftcache.h>
+
+
+// The set of Unicode characters covered by a face, stored as a two-level
+// bitset: Only pages with at least one covered character are allocated, and
+// a lookup takes constant time.
+class CharCoverage
+{
+public:
+  void build(FT_Face face); // Uses the face's Unicode charmap, if any.
+  void clear() { pages_.clear(); }
+
+  bool contains(unsigned long charCode) const
+  {
+    auto pageIndex = charCode >> PageShift;
+    if (pageIndex >= pages_.size() || !pages_[pageIndex])
+      return false;
+    return pages_[pageIndex]->test(charCode & (PageSize - 1));
+  }
+
+private:
+  constexpr static int PageShift = 10;
+  constexpr static unsigned long PageSize = 1UL << PageShift;
+  constexpr static unsigned long MaxCharCode = 0x10FFFF;
+
+  std::vector<std::unique_ptr<std::bitset<PageSize>>> pages_;
+};
+
+
+class Engine;
+
+// Font fallback for string rendering: The opened fonts (first face only) are
+// searched in order for a character the current font doesn't cover.  To keep
+// the current font's objects in the FreeType cache alive, fallback fonts are
+// opened as separate face objects.  Their coverage is computed only once.
+class FontFallback
+{
+public:
+  FontFallback(Engine* engine);
+  ~FontFallback();
+
+  // Return the index of the first opened font except `excludeFontIndex`
+  // that covers `charCode` (a Unicode value), or -1 if none.  The glyph index
+  // is returned in `outGlyphIndex`.
+  int findFont(unsigned long charCode,
+               int excludeFontIndex,
+               unsigned* outGlyphIndex);
+
+  // Load a glyph of a font returned by `findFont` into the glyph slot of the
+  // fallback face, using the size and load flags of the current font.
+  // Return NULL on error.
+  //
+  // Unlike the engine's loading functions, this doesn't apply the time
+  // budget for glyphs, and rejections aren't remembered: the glyph slot
+  // belongs to a face outside of the engine's cache.  The bytecode budget
+  // still holds since it is a property of the engine's library.
+  FT_GlyphSlot loadGlyph(int fontIndex,
+                         unsigned glyphIndex);
+
+  void closeFaces(); // Drop face objects but keep the coverage.
+  void clear(); // Needed whenever fonts are removed or reloaded.
+
+private:
+  struct Entry
+  {
+    bool coverageValid = false;
+    CharCoverage coverage;
+    FT_Face face = NULL;
+    FTC_ScalerRec size = {}; // The size last set for `face`.
+  };
+
+  Engine* engine_;
+  std::vector<Entry> entries_;
+
+  FT_Face openFace(int fontIndex);
+};
+
+
+// end of fontfallback.hpp
@@ -500,7 +500,8 @@ void readSingleFace(QFile& file,
       info.length = t.length;
       info.offset = t.offset;
       info.sharedFaces.emplace(faceIndex);
-      info.valid = true;
+      // The table must lie completely within the file.
+      info.valid = static_cast<qint64>(t.offset) + t.length <= file.size();
     }
     else
     {
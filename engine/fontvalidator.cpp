@@ -0,0 +1,252 @@
+// fontvalidator.cpp
+
+// Copyright (C) 2022-2023 by
+// Charlie Jiang.
+
+#include "fontvalidator.hpp"
+#include "renderscheduler.hpp"
+
+#include <freetype/ftgxval.h>
+#include <freetype/ftotval.h>
+#include <freetype/tttables.h>
+#include <freetype/tttags.h>
+
+
+namespace
+{
+
+struct OTTableEntry
+{
+  FT_UInt flag;
+  unsigned long tag;
+};
+
+
+const OTTableEntry otTables[] =
+{
+  { FT_VALIDATE_BASE, TTAG_BASE },
+  { FT_VALIDATE_GDEF, TTAG_GDEF },
+  { FT_VALIDATE_GPOS, TTAG_GPOS },
+  { FT_VALIDATE_GSUB, TTAG_GSUB },
+  { FT_VALIDATE_JSTF, TTAG_JSTF },
+  { FT_VALIDATE_MATH, TTAG_MATH },
+};
+
+
+// Ordered by `FT_VALIDATE_*_INDEX`.
+const OTTableEntry gxTables[FT_VALIDATE_GX_LENGTH] =
+{
+  { FT_VALIDATE_feat, TTAG_feat },
+  { FT_VALIDATE_mort, TTAG_mort },
+  { FT_VALIDATE_morx, TTAG_morx },
+  { FT_VALIDATE_bsln, TTAG_bsln },
+  { FT_VALIDATE_just, TTAG_just },
+  { FT_VALIDATE_kern, TTAG_kern },
+  { FT_VALIDATE_opbd, TTAG_opbd },
+  { FT_VALIDATE_trak, TTAG_trak },
+  { FT_VALIDATE_prop, TTAG_prop },
+  { FT_VALIDATE_lcar, TTAG_lcar },
+};
+
+
+QString
+errorMessage(FT_Error error)
+{
+  if (!error)
+    return QStringLiteral("OK");
+
+  auto errString = FT_Error_String(error);
+  if (!errString)
+    return QString("error 0x%1").arg(error, 2, 16, QChar('0'));
+  return QString("%1 (0x%2)").arg(errString).arg(error, 2, 16, QChar('0'));
+}
+
+
+void
+addResult(std::vector<ValidationResult>& results,
+          long faceIndex,
+          ValidationResult::Validator validator,
+          unsigned long tag,
+          FT_Error error)
+{
+  ValidationResult result;
+  result.faceIndex = faceIndex;
+  result.validator = validator;
+  result.tag = tag;
+  result.error = error;
+  result.message = errorMessage(error);
+  results.emplace_back(std::move(result));
+}
+
+
+bool
+hasTable(FT_Face face,
+         unsigned long tag)
+{
+  FT_ULong length = 0;
+  return !FT_Load_Sfnt_Table(face, tag, 0, NULL, &length) && length;
+}
+
+} // namespace
+
+
+QString
+ValidationResult::validatorName(Validator validator)
+{
+  switch (validator)
+  {
+  case V_Directory:
+    return QStringLiteral("Table Directory");
+  case V_OpenType:
+    return QStringLiteral("OpenType");
+  case V_TrueTypeGX:
+    return QStringLiteral("TrueTypeGX/AAT");
+  }
+  return {};
+}
+
+
+FontValidator::FontValidator(QObject* parent,
+                             RenderScheduler* scheduler)
+: QObject(parent),
+  scheduler_(scheduler)
+{
+}
+
+
+FontValidator::~FontValidator()
+{
+  scheduler_->remove(this);
+}
+
+
+void
+FontValidator::validate(QString const& filePath,
+                        long numFaces,
+                        std::vector<SFNTTableInfo> const& tables)
+{
+  cancel();
+
+  results_.clear();
+  for (auto& table : tables)
+    for (auto faceIndex : table.sharedFaces)
+      addResult(results_,
+                static_cast<long>(faceIndex),
+                ValidationResult::V_Directory,
+                table.tag,
+                table.valid ? FT_Err_Ok : FT_Err_Invalid_Table);
+
+  if (numFaces <= 0)
+  {
+    emit finished();
+    return;
+  }
+
+  totalFaces_ = static_cast<int>(numFaces);
+  pendingFaces_ = totalFaces_;
+
+  for (long faceIndex = 0; faceIndex < numFaces; faceIndex++)
+    scheduler_->submit(this, RenderScheduler::P_Background,
+                       [this, filePath, faceIndex]
+                       {
+                         auto faceResults = validateFace(filePath, faceIndex);
+                         return [this, faceResults]
+                                {
+                                  faceFinished(faceResults);
+                                };
+                       });
+
+  emit progress(0, totalFaces_);
+}
+
+
+void
+FontValidator::cancel()
+{
+  scheduler_->cancel(this);
+  pendingFaces_ = 0;
+}
+
+
+void
+FontValidator::faceFinished(std::vector<ValidationResult> const& faceResults)
+{
+  if (pendingFaces_ <= 0)
+    return;
+
+  results_.insert(results_.end(), faceResults.begin(), faceResults.end());
+  pendingFaces_--;
+
+  emit progress(totalFaces_ - pendingFaces_, totalFaces_);
+  if (pendingFaces_ == 0)
+    emit finished();
+}
+
+
+std::vector<ValidationResult>
+FontValidator::validateFace(QString const& filePath,
+                            long faceIndex)
+{
+  std::vector<ValidationResult> results;
+
+  FT_Library library = NULL;
+  FT_Face face = NULL;
+
+  auto error = FT_Init_FreeType(&library);
+  if (!error)
+    error = FT_New_Face(library, qPrintable(filePath), faceIndex, &face);
+  if (error)
+  {
+    addResult(results, faceIndex, ValidationResult::V_Directory, 0, error);
+    FT_Done_FreeType(library);
+    return results;
+  }
+
+  if (FT_IS_SFNT(face))
+  {
+    // Validate table by table so that errors can be attributed.
+    for (auto& entry : otTables)
+    {
+      if (!hasTable(face, entry.tag))
+        continue;
+
+      FT_Bytes tableData[5] = {};
+      error = FT_OpenType_Validate(face, entry.flag,
+                                   &tableData[0], &tableData[1],
+                                   &tableData[2], &tableData[3],
+                                   &tableData[4]);
+      for (auto data : tableData)
+        FT_OpenType_Free(face, data);
+
+      addResult(results, faceIndex, ValidationResult::V_OpenType,
+                entry.tag, error);
+      if (error == FT_Err_Unimplemented_Feature)
+        break; // The `otvalid` module is not available.
+    }
+
+    for (auto& entry : gxTables)
+    {
+      if (!hasTable(face, entry.tag))
+        continue;
+
+      FT_Bytes tableData[FT_VALIDATE_GX_LENGTH] = {};
+      error = FT_TrueTypeGX_Validate(face, entry.flag,
+                                     tableData, FT_VALIDATE_GX_LENGTH);
+      for (auto data : tableData)
+        FT_TrueTypeGX_Free(face, data);
+
+      addResult(results, faceIndex, ValidationResult::V_TrueTypeGX,
+                entry.tag, error);
+      if (error == FT_Err_Unimplemented_Feature)
+        break; // The `gxvalid` module is not available.
+    }
+  }
+
+  FT_Done_Face(face);
+  FT_Done_FreeType(library);
+
+  return results;
+}
+
+
+// end of fontvalidator.cpp
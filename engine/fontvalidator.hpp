@@ -0,0 +1,85 @@
+// fontvalidator.hpp
+
+// Copyright (C) 2022-2023 by
+// Charlie Jiang.
+
+#pragma once
+
+#include "fontinfo.hpp"
+
+#include <vector>
+
+#include <QObject>
+#include <QString>
+
+#include <freetype/freetype.h>
+
+
+class RenderScheduler;
+
+// One row of a validation report: the outcome of one check of one table in
+// one face.
+struct ValidationResult
+{
+  enum Validator : int
+  {
+    V_Directory,
+    V_OpenType,
+    V_TrueTypeGX
+  };
+
+  long faceIndex = 0;
+  Validator validator = V_Directory;
+  unsigned long tag = 0;
+  FT_Error error = FT_Err_Ok;
+  QString message;
+
+  static QString validatorName(Validator validator);
+};
+
+
+// Runs FreeType's `otvalid` and `gxvalid` modules over all faces of a font
+// file.  Each face is validated as a background job of the render
+// scheduler, using a private `FT_Library` object (FreeType objects must not
+// be shared between threads).  Results are collected in the GUI thread.
+
+class FontValidator
+: public QObject
+{
+  Q_OBJECT
+
+public:
+  FontValidator(QObject* parent,
+                RenderScheduler* scheduler);
+  ~FontValidator() override;
+
+  // `tables` is the table directory of the file as returned by
+  // `SFNTTableInfo::getForAll`; its checks are added to the report.  A
+  // running validation is cancelled first.
+  void validate(QString const& filePath,
+                long numFaces,
+                std::vector<SFNTTableInfo> const& tables);
+  void cancel();
+
+  bool running() { return pendingFaces_ > 0; }
+  std::vector<ValidationResult>& results() { return results_; }
+
+signals:
+  void progress(int finishedFaces,
+                int totalFaces);
+  void finished();
+
+private:
+  RenderScheduler* scheduler_;
+  int pendingFaces_ = 0;
+  int totalFaces_ = 0;
+  std::vector<ValidationResult> results_;
+
+  void faceFinished(std::vector<ValidationResult> const& faceResults);
+
+  static std::vector<ValidationResult> validateFace(QString const& filePath,
+                                                    long faceIndex);
+};
+
+
+// end of fontvalidator.hpp
@@ -0,0 +1,192 @@
+// fontwall.cpp
+
+// Copyright (C) 2022-2023 by
+// Charlie Jiang.
+
+#include "fontwall.hpp"
+
+#include <QFileInfo>
+
+#include <freetype/ftbitmap.h>
+
+
+namespace
+{
+
+// Darken the image with the bitmap's coverage; `bitmap` must be 8-bit gray.
+void
+blitGray(QImage& image,
+         FT_Bitmap const& bitmap,
+         int x,
+         int y)
+{
+  auto maxValue = bitmap.num_grays > 1 ? bitmap.num_grays - 1 : 255;
+  for (unsigned row = 0; row < bitmap.rows; row++)
+  {
+    auto dstY = y + static_cast<int>(row);
+    if (dstY < 0 || dstY >= image.height())
+      continue;
+
+    auto src = bitmap.buffer + static_cast<int>(row) * bitmap.pitch;
+    auto dst = image.scanLine(dstY);
+    for (unsigned col = 0; col < bitmap.width; col++)
+    {
+      auto dstX = x + static_cast<int>(col);
+      if (dstX < 0 || dstX >= image.width())
+        continue;
+
+      auto value = 255 - src[col] * 255 / maxValue;
+      if (value < dst[dstX])
+        dst[dstX] = static_cast<uchar>(value);
+    }
+  }
+}
+
+
+QString
+entryName(FT_Face face,
+          FontWallEntry const& entry)
+{
+  QString name = QString("%1 %2").arg(face->family_name)
+                                  .arg(face->style_name);
+  if (face->num_faces > 1 || entry.namedInstanceIndex > 0)
+    name += QString(" [%1/%2]").arg(entry.faceIndex)
+                               .arg(entry.namedInstanceIndex);
+  return name;
+}
+
+} // namespace
+
+
+std::vector<FontWallEntry>
+FontWallRenderer::enumerate(QStringList const& filePaths)
+{
+  std::vector<FontWallEntry> entries;
+
+  FT_Library library = NULL;
+  if (FT_Init_FreeType(&library))
+    return entries;
+
+  for (int i = 0; i < filePaths.size(); i++)
+  {
+    auto path = filePaths[i].toLocal8Bit();
+    FT_Face face = NULL;
+
+    // Face index -1 only checks the file and returns the number of faces.
+    if (FT_New_Face(library, path.constData(), -1, &face))
+      continue;
+    auto numFaces = face->num_faces;
+    FT_Done_Face(face);
+
+    for (long faceIndex = 0; faceIndex < numFaces; faceIndex++)
+    {
+      // The negative face index `-(n + 1)` retrieves the number of named
+      // instances of face `n` cheaply.
+      int numNamedInstances = 0;
+      if (!FT_New_Face(library, path.constData(), -(faceIndex + 1), &face))
+      {
+        numNamedInstances = static_cast<int>(face->style_flags >> 16);
+        FT_Done_Face(face);
+      }
+
+      for (int instance = 0; instance <= numNamedInstances; instance++)
+      {
+        FontWallEntry entry;
+        entry.fontIndex = i;
+        entry.faceIndex = faceIndex;
+        entry.namedInstanceIndex = instance;
+        entry.filePath = filePaths[i];
+        entries.push_back(entry);
+      }
+    }
+  }
+
+  FT_Done_FreeType(library);
+  return entries;
+}
+
+
+FontWallResult
+FontWallRenderer::render(FontWallEntry const& entry,
+                         FontWallParameters const& params)
+{
+  FontWallResult result;
+
+  FT_Library library = NULL;
+  FT_Face face = NULL;
+  FT_Long faceIndex = entry.faceIndex
+                      + (static_cast<FT_Long>(entry.namedInstanceIndex)
+                         << 16);
+
+  auto error = FT_Init_FreeType(&library);
+  if (!error)
+    error = FT_New_Face(library, qPrintable(entry.filePath), faceIndex,
+                        &face);
+  if (!error)
+  {
+    error = FT_Set_Pixel_Sizes(face, 0,
+                               static_cast<FT_UInt>(params.pixelSize));
+    // Bitmap-only fonts: Fall back to the first strike.
+    if (error && face->num_fixed_sizes > 0)
+      error = FT_Select_Size(face, 0);
+  }
+  if (error)
+  {
+    result.name = QString("%1 [%2/%3] (error 0x%4)")
+                    .arg(QFileInfo(entry.filePath).fileName())
+                    .arg(entry.faceIndex)
+                    .arg(entry.namedInstanceIndex)
+                    .arg(error, 2, 16, QChar('0'));
+    if (face)
+      FT_Done_Face(face);
+    FT_Done_FreeType(library);
+    return result;
+  }
+
+  result.name = entryName(face, entry);
+
+  auto height = params.imageHeight();
+  auto baseline = height * 4 / 5;
+  QImage image(params.maxWidth, height, QImage::Format_Grayscale8);
+  image.fill(255);
+
+  FT_Bitmap converted;
+  FT_Bitmap_Init(&converted);
+
+  int penX = 0;
+  auto text = params.text.toUcs4();
+  for (auto charCode : text)
+  {
+    if (penX >= params.maxWidth)
+      break;
+
+    auto glyphIndex = FT_Get_Char_Index(face, charCode);
+    if (FT_Load_Glyph(face, glyphIndex, params.loadFlags | FT_LOAD_RENDER))
+      continue;
+
+    auto slot = face->glyph;
+    FT_Bitmap* bitmap = &slot->bitmap;
+    if (bitmap->pixel_mode != FT_PIXEL_MODE_GRAY)
+    {
+      if (FT_Bitmap_Convert(library, bitmap, &converted, 1))
+        bitmap = NULL;
+      else
+        bitmap = &converted;
+    }
+    if (bitmap)
+      blitGray(image, *bitmap,
+               penX + slot->bitmap_left, baseline - slot->bitmap_top);
+
+    penX += static_cast<int>((slot->advance.x + 32) >> 6);
+  }
+
+  FT_Bitmap_Done(library, &converted);
+  FT_Done_Face(face);
+  FT_Done_FreeType(library);
+
+  result.image = image.copy(0, 0, qBound(1, penX, params.maxWidth), height);
+  return result;
+}
+
+
+// end of fontwall.cpp
@@ -0,0 +1,76 @@
+// fontwall.hpp
+
+// Copyright (C) 2022-2023 by
+// Charlie Jiang.
+
+#pragma once
+
+#include <vector>
+
+#include <QImage>
+#include <QString>
+#include <QStringList>
+
+#include <freetype/freetype.h>
+
+
+// One row of the font wall: a face or a named instance of an opened font.
+struct FontWallEntry
+{
+  int fontIndex = -1;
+  long faceIndex = 0;
+  int namedInstanceIndex = 0; // 0 represents no named instance selected.
+  QString filePath;
+};
+
+
+struct FontWallParameters
+{
+  QString text;
+  int pixelSize = 24;
+  int maxWidth = 1024; // Rendering stops at this width.
+  FT_Int32 loadFlags = FT_LOAD_DEFAULT;
+  bool isolated = false; // Render in a `RenderWorkerPool` process.
+
+  bool operator==(FontWallParameters const& other) const
+  {
+    return text == other.text
+           && pixelSize == other.pixelSize
+           && maxWidth == other.maxWidth
+           && loadFlags == other.loadFlags
+           && isolated == other.isolated;
+  }
+  bool operator!=(FontWallParameters const& other) const
+  {
+    return !(*this == other);
+  }
+
+  // All rows have the same height so that the list can be virtualized.
+  int imageHeight() const { return pixelSize * 3 / 2; }
+};
+
+
+struct FontWallResult
+{
+  QString name;
+  QImage image; // Black text on white background, in `Format_Grayscale8`.
+};
+
+
+// Stateless helpers for the font wall.  Unlike the rest of the engine they
+// don't use the `Engine` object: `render` runs in worker threads, each with
+// a private `FT_Library` object, so that rows never go through the cache
+// and the current font stays untouched.
+class FontWallRenderer
+{
+public:
+  // List all faces and named instances of the given files.  Files that
+  // can't be opened are skipped.
+  static std::vector<FontWallEntry> enumerate(QStringList const& filePaths);
+
+  static FontWallResult render(FontWallEntry const& entry,
+                               FontWallParameters const& params);
+};
+
+
+// end of fontwall.hpp
@@ -0,0 +1,278 @@
+// glyphtimer.cpp
+
+// Copyright (C) 2022-2023 by
+// Charlie Jiang.
+
+#include "engine.hpp"
+#include "glyphtimer.hpp"
+#include "renderscheduler.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <memory>
+
+#include <QElapsedTimer>
+#include <QThread>
+
+#include <freetype/ftmm.h>
+
+
+namespace
+{
+
+std::vector<FT_Fixed>
+designCoords(FT_Face face)
+{
+  std::vector<FT_Fixed> coords;
+  FT_MM_Var* mm = NULL;
+  if (!FT_HAS_MULTIPLE_MASTERS(face) || FT_Get_MM_Var(face, &mm))
+    return coords;
+
+  coords.resize(mm->num_axis);
+  if (FT_Get_Var_Design_Coordinates(face, mm->num_axis, coords.data()))
+    coords.clear();
+  FT_Done_MM_Var(face->glyph->library, mm);
+
+  return coords;
+}
+
+} // namespace
+
+
+GlyphTimer::GlyphTimer(QObject* parent,
+                       RenderScheduler* scheduler)
+: QObject(parent),
+  scheduler_(scheduler)
+{
+}
+
+
+GlyphTimer::~GlyphTimer()
+{
+  scheduler_->remove(this);
+}
+
+
+void
+GlyphTimer::measure(Engine* engine)
+{
+  clear();
+
+  auto face = engine->currentFallbackFtFace();
+  auto fontIndex = engine->currentFontIndex();
+  auto& fileManager = engine->fontFileManager();
+  if (!face || fontIndex < 0 || fontIndex >= fileManager.size()
+      || face->num_glyphs <= 0)
+  {
+    emit finished();
+    return;
+  }
+
+  job_.fontIndex = fontIndex;
+  job_.filePath = fileManager[fontIndex].filePath();
+  job_.faceIndex = face->face_index; // Includes the named instance.
+  job_.coords = designCoords(face);
+  job_.scaler = *engine->scaler();
+  job_.loadFlags = static_cast<FT_Int32>(engine->loadFlags());
+  job_.renderMode = engine->renderMode();
+
+  auto numGlyphs = static_cast<int>(qMin(face->num_glyphs,
+                                         static_cast<FT_Long>(INT_MAX)));
+  times_.assign(numGlyphs, -1);
+
+  auto chunks = qMin(numGlyphs,
+                     qMax(QThread::idealThreadCount(), 1) * ChunksPerThread);
+  auto chunkSize = (numGlyphs + chunks - 1) / chunks;
+  auto job = job_;
+  for (int begin = 0; begin < numGlyphs; begin += chunkSize)
+  {
+    auto end = qMin(begin + chunkSize, numGlyphs);
+
+    // The library is set up here since reading the engine's properties
+    // isn't thread-safe.  It is owned by the task and thus also freed if
+    // the task is dropped by `cancel`.
+    FT_Library library = NULL;
+    if (FT_Init_FreeType(&library))
+      continue;
+    engine->applyDriverProperties(library);
+    // Caches that keep per-glyph data would make all but the first run of
+    // a glyph measure a cache hit.
+    FT_Bool noCache = false;
+    FT_Property_Set(library, "truetype", "component-cache", &noCache);
+    FT_Property_Set(library, "t1cid", "charstring-cache", &noCache);
+    std::shared_ptr<FT_LibraryRec_> libraryOwner(library, FT_Done_FreeType);
+
+    pendingChunks_++;
+    scheduler_->submit(this, RenderScheduler::P_Background,
+                       [this, job, begin, end, libraryOwner]
+                       {
+                         auto times = measureRange(libraryOwner.get(), job,
+                                                   begin, end);
+                         return [this, begin, times]
+                                {
+                                  chunkFinished(begin, times);
+                                };
+                       });
+  }
+
+  if (pendingChunks_ == 0)
+    emit finished();
+  else
+    emit progress(0, numGlyphs);
+}
+
+
+void
+GlyphTimer::cancel()
+{
+  scheduler_->cancel(this);
+  pendingChunks_ = 0;
+}
+
+
+void
+GlyphTimer::clear()
+{
+  cancel();
+  job_ = Job();
+  times_.clear();
+  finishedGlyphs_ = 0;
+  referenceTime_ = 0;
+}
+
+
+bool
+GlyphTimer::matches(Engine* engine)
+{
+  auto face = engine->currentFallbackFtFace();
+  if (!face || job_.fontIndex < 0)
+    return false;
+
+  auto scaler = engine->scaler();
+  return job_.fontIndex == engine->currentFontIndex()
+         && job_.faceIndex == face->face_index
+         && job_.scaler.width == scaler->width
+         && job_.scaler.height == scaler->height
+         && job_.scaler.pixel == scaler->pixel
+         && job_.scaler.x_res == scaler->x_res
+         && job_.scaler.y_res == scaler->y_res
+         && job_.loadFlags == static_cast<FT_Int32>(engine->loadFlags())
+         && job_.renderMode == engine->renderMode()
+         && job_.coords == designCoords(face);
+}
+
+
+void
+GlyphTimer::chunkFinished(int begin,
+                          std::vector<qint64> const& times)
+{
+  if (pendingChunks_ <= 0)
+    return;
+
+  std::copy(times.begin(), times.end(), times_.begin() + begin);
+  finishedGlyphs_ += static_cast<int>(times.size());
+  pendingChunks_--;
+  updateReferenceTime();
+
+  emit progress(finishedGlyphs_, static_cast<int>(times_.size()));
+  if (pendingChunks_ == 0)
+    emit finished();
+}
+
+
+void
+GlyphTimer::updateReferenceTime()
+{
+  std::vector<qint64> measured;
+  measured.reserve(times_.size());
+  for (auto time : times_)
+    if (time >= 0)
+      measured.push_back(time);
+
+  if (measured.empty())
+  {
+    referenceTime_ = 0;
+    return;
+  }
+
+  auto middle = measured.begin() + measured.size() / 2;
+  std::nth_element(measured.begin(), middle, measured.end());
+  referenceTime_ = *middle;
+}
+
+
+std::vector<qint64>
+GlyphTimer::measureRange(FT_Library library,
+                         Job const& job,
+                         int begin,
+                         int end)
+{
+  std::vector<qint64> times(end - begin, -1);
+
+  FT_Face face = NULL;
+  if (FT_New_Face(library, qPrintable(job.filePath), job.faceIndex, &face))
+    return times;
+
+  if (!job.coords.empty())
+    FT_Set_Var_Design_Coordinates(face,
+                                  static_cast<FT_UInt>(job.coords.size()),
+                                  const_cast<FT_Fixed*>(job.coords.data()));
+
+  // Same as the cache manager does for the current font.
+  FT_Error error;
+  if (job.scaler.pixel)
+    error = FT_Set_Pixel_Sizes(face, job.scaler.width, job.scaler.height);
+  else
+    error = FT_Set_Char_Size(face,
+                             static_cast<FT_F26Dot6>(job.scaler.width),
+                             static_cast<FT_F26Dot6>(job.scaler.height),
+                             job.scaler.x_res,
+                             job.scaler.y_res);
+  if (error)
+  {
+    FT_Done_Face(face);
+    return times;
+  }
+
+  // Note that all workers run at the same time; absolute numbers are thus
+  // a bit higher than for a single thread, but the relative cost of glyphs
+  // is what we are interested in.
+  //
+  // Each run walks the whole range so that a glyph is never loaded twice
+  // in a row, which would measure warm CPU caches only.
+  QElapsedTimer timer;
+  std::vector<qint64> runs((end - begin) * Runs, -1);
+  std::vector<bool> failed(end - begin, false);
+  for (int run = 0; run < Runs; run++)
+    for (int i = begin; i < end; i++)
+    {
+      if (failed[i - begin])
+        continue;
+
+      timer.start();
+      if (FT_Load_Glyph(face, static_cast<FT_UInt>(i), job.loadFlags)
+          || (face->glyph->format != FT_GLYPH_FORMAT_BITMAP
+              && FT_Render_Glyph(face->glyph, job.renderMode)))
+      {
+        failed[i - begin] = true;
+        continue;
+      }
+      runs[(i - begin) * Runs + run] = timer.nsecsElapsed();
+    }
+
+  for (int i = begin; i < end; i++)
+  {
+    if (failed[i - begin])
+      continue;
+
+    auto glyphRuns = runs.begin() + (i - begin) * Runs;
+    std::nth_element(glyphRuns, glyphRuns + Runs / 2, glyphRuns + Runs);
+    times[i - begin] = glyphRuns[Runs / 2];
+  }
+
+  FT_Done_Face(face);
+  return times;
+}
+
+
+// end of glyphtimer.cpp
@@ -0,0 +1,93 @@
+// glyphtimer.hpp
+
+// Copyright (C) 2022-2023 by
+// Charlie Jiang.
+
+#pragma once
+
+#include <vector>
+
+#include <QObject>
+#include <QString>
+
+#include <freetype/freetype.h>
+#include <freetype/ftcache.h>
+
+
+class Engine;
+class RenderScheduler;
+
+// Measures how long loading and rendering takes for each glyph of the
+// current font, with the current size and settings.  Every glyph is loaded
+// several times, interleaved with the other glyphs and with per-glyph
+// driver caches off, and the median is taken.  The glyph range is split into
+// chunks, and each chunk is measured as a background job of the render
+// scheduler with a private `FT_Library` object (carrying the engine's
+// driver properties) and face.  Results arrive chunk by chunk in the GUI
+// thread; this works the same for all font drivers.
+
+class GlyphTimer
+: public QObject
+{
+  Q_OBJECT
+
+public:
+  GlyphTimer(QObject* parent,
+             RenderScheduler* scheduler);
+  ~GlyphTimer() override;
+
+  // A running measurement is cancelled first.  Call `Engine::reloadFont`
+  // before so that the current face is valid.
+  void measure(Engine* engine);
+  void cancel();
+  void clear();
+
+  bool running() { return pendingChunks_ > 0; }
+  // Do the results belong to the engine's current font and settings?
+  bool matches(Engine* engine);
+
+  // Median time in nanoseconds, indexed by glyph index; -1 if not (yet)
+  // measured or if the glyph can't be loaded.
+  std::vector<qint64> const& times() { return times_; }
+  // Median of all measured glyphs, as a reference for outliers.
+  qint64 referenceTime() { return referenceTime_; }
+
+signals:
+  void progress(int finishedGlyphs,
+                int totalGlyphs);
+  void finished();
+
+private:
+  constexpr static int Runs = 5;
+  constexpr static int ChunksPerThread = 4;
+
+  struct Job
+  {
+    int fontIndex = -1;
+    QString filePath;
+    FT_Long faceIndex = 0;
+    std::vector<FT_Fixed> coords;
+    FTC_ScalerRec scaler = {};
+    FT_Int32 loadFlags = 0;
+    FT_Render_Mode renderMode = FT_RENDER_MODE_NORMAL;
+  };
+
+  RenderScheduler* scheduler_;
+  int pendingChunks_ = 0;
+  int finishedGlyphs_ = 0;
+  Job job_;
+  std::vector<qint64> times_;
+  qint64 referenceTime_ = 0;
+
+  void chunkFinished(int begin,
+                     std::vector<qint64> const& times);
+  void updateReferenceTime();
+
+  static std::vector<qint64> measureRange(FT_Library library,
+                                          Job const& job,
+                                          int begin,
+                                          int end);
+};
+
+
+// end of glyphtimer.hpp
@@ -0,0 +1,273 @@
+// ppemsweep.cpp
+
+// Copyright (C) 2022-2023 by
+// Charlie Jiang.
+
+#include "engine.hpp"
+#include "ppemsweep.hpp"
+#include "renderscheduler.hpp"
+
+#include <cstdlib>
+#include <memory>
+
+#include <QThread>
+
+#include <freetype/ftbitmap.h>
+#include <freetype/ftmm.h>
+
+
+PpemSweep::PpemSweep(QObject* parent,
+                     Engine* engine,
+                     RenderScheduler* scheduler)
+: QObject(parent),
+  engine_(engine),
+  scheduler_(scheduler)
+{
+}
+
+
+PpemSweep::~PpemSweep()
+{
+  scheduler_->remove(this);
+}
+
+
+void
+PpemSweep::setRange(int firstPpem,
+                    int lastPpem)
+{
+  firstPpem = qMax(firstPpem, 1);
+  lastPpem = qMax(lastPpem, firstPpem);
+  if (firstPpem == firstPpem_ && lastPpem == lastPpem_)
+    return;
+
+  firstPpem_ = firstPpem;
+  lastPpem_ = lastPpem;
+  clear();
+}
+
+
+std::vector<PpemSweepImage> const&
+PpemSweep::render(int glyphIndex)
+{
+  auto it = cache_.find(glyphIndex);
+  if (it != cache_.end())
+    return it->second;
+
+  if (glyphIndex == pendingGlyph_)
+    return empty_;
+  cancel();
+
+  auto current = engine_->currentFallbackFtFace();
+  auto fontIndex = engine_->currentFontIndex();
+  auto& fileManager = engine_->fontFileManager();
+  if (!current || fontIndex < 0 || fontIndex >= fileManager.size())
+    return empty_;
+
+  Job job;
+  job.filePath = fileManager[fontIndex].filePath();
+  // `face_index` includes the named instance in the upper 16 bits.
+  job.faceIndex = current->face_index;
+  job.loadFlags = static_cast<FT_Int32>(engine_->loadFlags());
+  job.renderMode = engine_->renderMode();
+  job.glyphIndex = glyphIndex;
+  job.firstPpem = firstPpem_;
+  job.count = lastPpem_ - firstPpem_ + 1;
+
+  // Carry over the design coordinates set in the settings panel.
+  FT_MM_Var* mm = NULL;
+  if (FT_HAS_MULTIPLE_MASTERS(current)
+      && !FT_Get_MM_Var(current, &mm))
+  {
+    job.coords.resize(mm->num_axis);
+    if (FT_Get_Var_Design_Coordinates(current, mm->num_axis,
+                                      job.coords.data()))
+      job.coords.clear();
+    FT_Done_MM_Var(engine_->ftLibrary(), mm);
+  }
+
+  pendingGlyph_ = glyphIndex;
+  pendingImages_.assign(job.count, PpemSweepImage());
+
+  auto step = qMax(qMin(qMin(MaxJobs, QThread::idealThreadCount()),
+                        job.count),
+                   1);
+  for (int first = 0; first < step; first++)
+  {
+    // The library is set up here since reading the engine's properties
+    // isn't thread-safe.  It is owned by the job and thus also freed if
+    // the job is dropped by `cancel`.
+    FT_Library library = NULL;
+    if (FT_Init_FreeType(&library))
+      continue;
+    engine_->applyDriverProperties(library);
+    std::shared_ptr<FT_LibraryRec_> libraryOwner(library, FT_Done_FreeType);
+
+    // Interleave the sizes so that all jobs get similar loads.
+    pendingJobs_++;
+    scheduler_->submit(this, RenderScheduler::P_Visible,
+                       [this, job, first, step, libraryOwner]
+                       {
+                         auto bitmaps = renderSizes(libraryOwner.get(), job,
+                                                    first, step);
+                         auto glyphIndex = job.glyphIndex;
+                         return [this, glyphIndex, first, step, bitmaps]
+                                {
+                                  jobFinished(glyphIndex, first, step,
+                                              bitmaps);
+                                };
+                       });
+  }
+
+  if (pendingJobs_ == 0)
+    cancel();
+  return empty_;
+}
+
+
+void
+PpemSweep::clear()
+{
+  cancel();
+  cache_.clear();
+}
+
+
+void
+PpemSweep::cancel()
+{
+  scheduler_->cancel(this);
+  pendingGlyph_ = -1;
+  pendingJobs_ = 0;
+  pendingImages_.clear();
+}
+
+
+void
+PpemSweep::jobFinished(int glyphIndex,
+                       int first,
+                       int step,
+                       std::vector<RawBitmap> const& bitmaps)
+{
+  if (glyphIndex != pendingGlyph_ || pendingJobs_ <= 0)
+    return;
+
+  for (size_t i = 0; i < bitmaps.size(); i++)
+  {
+    auto index = first + static_cast<size_t>(step) * i;
+    if (index < pendingImages_.size())
+      pendingImages_[index] = convertBitmap(bitmaps[i]);
+  }
+  if (--pendingJobs_ > 0)
+    return;
+
+  if (cache_.size() >= MaxCachedGlyphs)
+    cache_.clear();
+  cache_[glyphIndex] = std::move(pendingImages_);
+  pendingImages_.clear();
+  pendingGlyph_ = -1;
+
+  emit finished();
+}
+
+
+PpemSweepImage
+PpemSweep::convertBitmap(RawBitmap const& raw)
+{
+  PpemSweepImage result;
+  result.ppem = raw.ppem;
+  result.left = raw.left;
+  result.top = raw.top;
+  if (raw.buffer.empty())
+    return result;
+
+  // `convertBitmapToQImage` doesn't modify 8-bit data.
+  auto bitmap = raw.bitmap;
+  bitmap.buffer = const_cast<unsigned char*>(raw.buffer.data());
+  std::unique_ptr<QImage> image(
+    engine_->renderingEngine()->convertBitmapToQImage(&bitmap));
+  if (image)
+    result.image = *image;
+
+  return result;
+}
+
+
+std::vector<PpemSweep::RawBitmap>
+PpemSweep::renderSizes(FT_Library library,
+                       Job const& job,
+                       int first,
+                       int step)
+{
+  std::vector<RawBitmap> bitmaps;
+  for (int i = first; i < job.count; i += step)
+  {
+    RawBitmap bitmap;
+    bitmap.ppem = job.firstPpem + i;
+    bitmaps.push_back(bitmap);
+  }
+
+  FT_Face face = NULL;
+  if (FT_New_Face(library, qPrintable(job.filePath), job.faceIndex, &face))
+    return bitmaps;
+  if (!job.coords.empty())
+    FT_Set_Var_Design_Coordinates(face,
+                                  static_cast<FT_UInt>(job.coords.size()),
+                                  const_cast<FT_Fixed*>(job.coords.data()));
+
+  for (auto& bitmap : bitmaps)
+    bitmap = renderSize(face, job, bitmap.ppem);
+
+  FT_Done_Face(face);
+  return bitmaps;
+}
+
+
+PpemSweep::RawBitmap
+PpemSweep::renderSize(FT_Face face,
+                      Job const& job,
+                      int ppem)
+{
+  RawBitmap result;
+  result.ppem = ppem;
+
+  if (FT_Set_Pixel_Sizes(face, 0, static_cast<FT_UInt>(ppem))
+      || FT_Load_Glyph(face, static_cast<FT_UInt>(job.glyphIndex),
+                       job.loadFlags))
+    return result;
+
+  auto slot = face->glyph;
+  if (slot->format != FT_GLYPH_FORMAT_BITMAP
+      && FT_Render_Glyph(slot, job.renderMode))
+    return result;
+
+  // 2- and 4-bit gray bitmaps are converted here with the job's library;
+  // the rendering engine would use the engine's one.
+  FT_Bitmap converted;
+  FT_Bitmap_Init(&converted);
+  auto bitmap = &slot->bitmap;
+  FT_Error error = FT_Err_Ok;
+  if (bitmap->pixel_mode == FT_PIXEL_MODE_GRAY2
+      || bitmap->pixel_mode == FT_PIXEL_MODE_GRAY4)
+  {
+    error = FT_Bitmap_Convert(slot->library, bitmap, &converted, 1);
+    bitmap = &converted;
+  }
+
+  auto size = static_cast<size_t>(bitmap->rows)
+              * static_cast<size_t>(std::abs(bitmap->pitch));
+  if (!error && bitmap->buffer && size)
+  {
+    result.bitmap = *bitmap;
+    result.bitmap.buffer = NULL;
+    result.buffer.assign(bitmap->buffer, bitmap->buffer + size);
+  }
+  result.left = slot->bitmap_left;
+  result.top = slot->bitmap_top;
+
+  FT_Bitmap_Done(slot->library, &converted);
+  return result;
+}
+
+
+// end of ppemsweep.cpp
@@ -0,0 +1,128 @@
+// ppemsweep.hpp
+
+// Copyright (C) 2022-2023 by
+// Charlie Jiang.
+
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include <QImage>
+#include <QObject>
+#include <QString>
+
+#include <freetype/freetype.h>
+
+
+// A glyph rendered at one ppem value; `left` and `top` are the bitmap
+// offsets as in `FT_GlyphSlot`.  `image` is null if the glyph is empty or
+// the size is not available.
+struct PpemSweepImage
+{
+  int ppem = 0;
+  QImage image;
+  int left = 0;
+  int top = 0;
+};
+
+
+class Engine;
+class RenderScheduler;
+
+// Render the same glyph at every ppem value of a range, using the current
+// font and settings.  The sizes are distributed over a few jobs of the
+// render scheduler with the `P_Visible` priority, each using a private
+// `FT_Library` object (carrying the engine's driver properties) and face.
+// The jobs return plain bitmaps, which are turned into images with the
+// current colors in the GUI thread.  `render` doesn't wait for them;
+// `finished` is emitted once all sizes of the requested glyph are done.
+//
+// Results are cached per glyph; call `clear` whenever the font or the
+// settings change, which also drops the pending jobs.
+class PpemSweep
+: public QObject
+{
+  Q_OBJECT
+
+public:
+  PpemSweep(QObject* parent,
+            Engine* engine,
+            RenderScheduler* scheduler);
+  ~PpemSweep() override;
+
+  int firstPpem() { return firstPpem_; }
+  int lastPpem() { return lastPpem_; }
+  void setRange(int firstPpem,
+                int lastPpem);
+
+  // Return the cached images of the glyph.  Otherwise, start rendering it
+  // (dropping the jobs of a previously requested glyph) and return an empty
+  // vector.  Call `Engine::reloadFont` before so that the current face is
+  // valid.
+  std::vector<PpemSweepImage> const& render(int glyphIndex);
+  void clear();
+
+signals:
+  void finished();
+
+private:
+  constexpr static int MaxJobs = 8;
+  constexpr static size_t MaxCachedGlyphs = 64;
+
+  struct Job
+  {
+    QString filePath;
+    FT_Long faceIndex = 0;
+    std::vector<FT_Fixed> coords;
+    FT_Int32 loadFlags = 0;
+    FT_Render_Mode renderMode = FT_RENDER_MODE_NORMAL;
+    int glyphIndex = 0;
+    int firstPpem = 0;
+    int count = 0;
+  };
+
+  // A glyph bitmap copied out of a job's glyph slot.  It is converted to
+  // an image in the GUI thread since the colors used for that belong to
+  // the rendering engine.
+  struct RawBitmap
+  {
+    int ppem = 0;
+    FT_Bitmap bitmap = {}; // Without `buffer`; the data is in `buffer`.
+    std::vector<unsigned char> buffer;
+    int left = 0;
+    int top = 0;
+  };
+
+  Engine* engine_;
+  RenderScheduler* scheduler_;
+  int firstPpem_ = 6;
+  int lastPpem_ = 72;
+
+  int pendingGlyph_ = -1;
+  int pendingJobs_ = 0;
+  std::vector<PpemSweepImage> pendingImages_;
+
+  std::unordered_map<int, std::vector<PpemSweepImage>> cache_;
+  std::vector<PpemSweepImage> empty_;
+
+  void cancel();
+  void jobFinished(int glyphIndex,
+                   int first,
+                   int step,
+                   std::vector<RawBitmap> const& bitmaps);
+  PpemSweepImage convertBitmap(RawBitmap const& raw);
+
+  // Render every `step`-th size starting with index `first`.  These run in
+  // worker threads and must not access the engine.
+  static std::vector<RawBitmap> renderSizes(FT_Library library,
+                                            Job const& job,
+                                            int first,
+                                            int step);
+  static RawBitmap renderSize(FT_Face face,
+                              Job const& job,
+                              int ppem);
+};
+
+
+// end of ppemsweep.hpp
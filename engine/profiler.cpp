@@ -0,0 +1,408 @@
+// profiler.cpp
+
+// Copyright (C) 2022-2023 by
+// Charlie Jiang.
+
+#include "profiler.hpp"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMap>
+#include <QStringList>
+#include <QTextStream>
+
+#ifdef Q_OS_LINUX
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <elf.h>
+#include <execinfo.h>
+#include <link.h>
+#include <signal.h>
+#include <sys/time.h>
+#endif
+
+
+#ifdef Q_OS_LINUX
+
+namespace
+{
+
+constexpr int MaxSamples = 60000;
+constexpr int MaxDepth = 64;
+// The signal handler and the signal trampoline.
+constexpr int SkippedFrames = 2;
+
+struct Sample
+{
+  int depth;
+  void* frames[MaxDepth];
+};
+
+// Filled by the signal handler, so nothing may be allocated or locked
+// there: the buffer is set up in advance, and slots are claimed with an
+// atomic counter.  A slot is complete once `depth` is set; reading is only
+// done after the timer is stopped.
+std::vector<Sample> samples;
+std::atomic<int> nextSample(0);
+std::atomic<int> droppedSamples(0);
+bool profiling = false;
+
+
+void
+handleSignal(int)
+{
+  auto savedErrno = errno;
+
+  auto slot = nextSample.fetch_add(1, std::memory_order_relaxed);
+  if (slot < MaxSamples)
+    samples[slot].depth = backtrace(samples[slot].frames, MaxDepth);
+  else
+    droppedSamples.fetch_add(1, std::memory_order_relaxed);
+
+  errno = savedErrno;
+}
+
+
+// The functions of a module (the executable or a shared library), read
+// from its ELF symbol table.  Unlike `dladdr`, which only sees the dynamic
+// symbol table, this includes hidden and local symbols, e.g., FreeType's
+// internal functions.  Stripped modules only have dynamic symbols.
+class SymbolTable
+{
+public:
+  // `loadAddress` is where the module is mapped in this process.
+  SymbolTable(QString const& filePath,
+              quintptr loadAddress)
+  : loadAddress_(loadAddress)
+  {
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly))
+      return;
+    auto size = static_cast<size_t>(file.size());
+    auto data = file.map(0, file.size());
+    if (!data)
+      return;
+
+    if (!read(data, size, SHT_SYMTAB))
+      read(data, size, SHT_DYNSYM);
+    std::sort(symbols_.begin(), symbols_.end(),
+              [](Symbol const& a, Symbol const& b)
+              {
+                return a.value < b.value;
+              });
+  }
+
+
+  // `address` is relative to the module's load address.  An empty string
+  // is returned if no function contains it.
+  QString
+  find(quintptr address)
+  {
+    if (isExecutable_)
+      address += loadAddress_;
+
+    auto it = std::upper_bound(symbols_.begin(), symbols_.end(), address,
+                               [](quintptr value, Symbol const& symbol)
+                               {
+                                 return value < symbol.value;
+                               });
+    if (it == symbols_.begin())
+      return QString();
+    --it;
+    if (address >= it->value + qMax<quintptr>(it->size, 1))
+      return QString();
+    return it->name;
+  }
+
+private:
+  struct Symbol
+  {
+    quintptr value;
+    quintptr size;
+    QString name;
+  };
+
+  std::vector<Symbol> symbols_;
+  quintptr loadAddress_;
+  // Symbols of non-PIE executables have absolute addresses.
+  bool isExecutable_ = false;
+
+
+  bool
+  read(uchar const* data,
+       size_t size,
+       ElfW(Word) type)
+  {
+    if (size < sizeof(ElfW(Ehdr))
+        || std::memcmp(data, ELFMAG, SELFMAG)
+        || data[EI_CLASS] != (sizeof(void*) == 8 ? ELFCLASS64 : ELFCLASS32))
+      return false;
+
+    auto header = reinterpret_cast<ElfW(Ehdr) const*>(data);
+    if (header->e_shentsize != sizeof(ElfW(Shdr))
+        || header->e_shoff > size
+        || header->e_shnum > (size - header->e_shoff) / sizeof(ElfW(Shdr)))
+      return false;
+    isExecutable_ = header->e_type == ET_EXEC;
+
+    auto sections = reinterpret_cast<ElfW(Shdr) const*>(data
+                                                        + header->e_shoff);
+    bool found = false;
+    for (int i = 0; i < header->e_shnum; i++)
+    {
+      auto& section = sections[i];
+      if (section.sh_type != type || section.sh_link >= header->e_shnum)
+        continue;
+      auto& strings = sections[section.sh_link];
+      if (section.sh_offset > size
+          || section.sh_size > size - section.sh_offset
+          || strings.sh_offset > size
+          || strings.sh_size > size - strings.sh_offset)
+        continue;
+
+      auto names = reinterpret_cast<char const*>(data + strings.sh_offset);
+      auto entries = reinterpret_cast<ElfW(Sym) const*>(data
+                                                        + section.sh_offset);
+      auto count = section.sh_size / sizeof(ElfW(Sym));
+      for (size_t j = 0; j < count; j++)
+      {
+        auto& entry = entries[j];
+        // `ELF32_ST_TYPE` is the same.
+        if (ELF64_ST_TYPE(entry.st_info) != STT_FUNC
+            || entry.st_shndx == SHN_UNDEF
+            || !entry.st_value
+            || entry.st_name >= strings.sh_size)
+          continue;
+
+        auto name = names + entry.st_name;
+        auto length = strnlen(name, strings.sh_size - entry.st_name);
+        symbols_.push_back({ static_cast<quintptr>(entry.st_value),
+                             static_cast<quintptr>(entry.st_size),
+                             QString::fromLatin1(name,
+                                                 static_cast<int>(length)) });
+        found = true;
+      }
+    }
+    return found;
+  }
+};
+
+
+QString
+demangle(QString const& name)
+{
+  int status;
+  auto latin1 = name.toLatin1();
+  auto demangled = abi::__cxa_demangle(latin1.constData(), NULL, NULL,
+                                       &status);
+  QString result = status == 0 ? QString(demangled) : name;
+  std::free(demangled);
+  return result.replace(';', ':'); // Reserved by the folded format.
+}
+
+
+// `tables` caches the symbol tables by load address of the module.
+QString
+symbolize(void* address,
+          bool isReturnAddress,
+          QHash<void*, std::shared_ptr<SymbolTable>>& tables)
+{
+  // A return address may already belong to the next function if the call
+  // is the last instruction.
+  auto lookup = static_cast<char*>(address) - (isReturnAddress ? 1 : 0);
+
+  Dl_info info;
+  if (!dladdr(lookup, &info) || !info.dli_fname)
+    return QString("0x%1").arg(reinterpret_cast<quintptr>(address), 0, 16);
+
+  auto offset = static_cast<quintptr>(lookup
+                                      - static_cast<char*>(info.dli_fbase));
+  auto& table = tables[info.dli_fbase];
+  if (!table)
+  {
+    // `dli_fname` of the executable is `argv[0]`, which may be relative or
+    // just a name from `PATH`.
+    Dl_info self;
+    auto isSelf = dladdr(reinterpret_cast<void*>(&handleSignal), &self)
+                  && self.dli_fbase == info.dli_fbase;
+    table = std::make_shared<SymbolTable>(
+              isSelf ? QString("/proc/self/exe")
+                     : QFile::decodeName(info.dli_fname),
+              reinterpret_cast<quintptr>(info.dli_fbase));
+  }
+
+  auto name = table->find(offset);
+  if (name.isEmpty() && info.dli_sname)
+    name = QString(info.dli_sname);
+  if (!name.isEmpty())
+    return demangle(name);
+
+  // Can be resolved with, e.g., `addr2line -f -e <module> <offset>`.
+  return QString("%1+0x%2")
+           .arg(QFileInfo(info.dli_fname).fileName())
+           .arg(offset, 0, 16);
+}
+
+} // namespace
+
+#endif // Q_OS_LINUX
+
+
+bool
+SamplingProfiler::available()
+{
+#ifdef Q_OS_LINUX
+  return true;
+#else
+  return false;
+#endif
+}
+
+
+bool
+SamplingProfiler::start(int frequency)
+{
+#ifdef Q_OS_LINUX
+  if (profiling || frequency <= 0)
+    return false;
+
+  samples.assign(MaxSamples, Sample());
+  nextSample = 0;
+  droppedSamples = 0;
+
+  // The first call of `backtrace` loads `libgcc_s`, which must not happen
+  // in the signal handler.
+  void* frames[1];
+  backtrace(frames, 1);
+
+  struct sigaction action = {};
+  action.sa_handler = handleSignal;
+  action.sa_flags = SA_RESTART;
+  sigemptyset(&action.sa_mask);
+  if (sigaction(SIGPROF, &action, NULL))
+    return false;
+
+  itimerval timer = {};
+  timer.it_interval.tv_usec = qMax(1000000 / frequency, 1);
+  timer.it_value = timer.it_interval;
+  if (setitimer(ITIMER_PROF, &timer, NULL))
+  {
+    signal(SIGPROF, SIG_IGN);
+    return false;
+  }
+
+  profiling = true;
+  return true;
+#else
+  Q_UNUSED(frequency)
+  return false;
+#endif
+}
+
+
+void
+SamplingProfiler::stop()
+{
+#ifdef Q_OS_LINUX
+  if (!profiling)
+    return;
+
+  itimerval timer = {};
+  setitimer(ITIMER_PROF, &timer, NULL);
+  // Not the default action, which would terminate the process if a signal
+  // is still pending.
+  signal(SIGPROF, SIG_IGN);
+  profiling = false;
+#endif
+}
+
+
+bool
+SamplingProfiler::running()
+{
+#ifdef Q_OS_LINUX
+  return profiling;
+#else
+  return false;
+#endif
+}
+
+
+int
+SamplingProfiler::sampleCount()
+{
+#ifdef Q_OS_LINUX
+  return qMin(nextSample.load(), MaxSamples);
+#else
+  return 0;
+#endif
+}
+
+
+int
+SamplingProfiler::droppedSampleCount()
+{
+#ifdef Q_OS_LINUX
+  return droppedSamples;
+#else
+  return 0;
+#endif
+}
+
+
+bool
+SamplingProfiler::writeFoldedStacks(QString const& filePath)
+{
+#ifdef Q_OS_LINUX
+  if (profiling)
+    return false;
+
+  QHash<void*, QString> symbols;
+  QHash<void*, std::shared_ptr<SymbolTable>> tables;
+  QMap<QString, int> stacks;
+  auto count = sampleCount();
+  for (int i = 0; i < count; i++)
+  {
+    auto& sample = samples[i];
+    QStringList frames;
+    // Outermost frame first; only the innermost frame is the interrupted
+    // instruction, all others are return addresses.
+    for (int j = sample.depth - 1; j >= SkippedFrames; j--)
+    {
+      auto address = sample.frames[j];
+      auto it = symbols.find(address);
+      if (it == symbols.end())
+        it = symbols.insert(address,
+                            symbolize(address, j != SkippedFrames,
+                                      tables));
+      frames.append(*it);
+    }
+    if (!frames.isEmpty())
+      stacks[frames.join(';')]++;
+  }
+
+  QFile file(filePath);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+    return false;
+
+  QTextStream stream(&file);
+  for (auto it = stacks.cbegin(); it != stacks.cend(); ++it)
+    stream << it.key() << ' ' << it.value() << '\n';
+  return stream.status() == QTextStream::Ok;
+#else
+  Q_UNUSED(filePath)
+  return false;
+#endif
+}
+
+
+// end of profiler.cpp
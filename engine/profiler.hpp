@@ -0,0 +1,48 @@
+// profiler.hpp
+
+// Copyright (C) 2022-2023 by
+// Charlie Jiang.
+
+#pragma once
+
+#include <QString>
+
+
+// A statistical profiler for the whole process, meant to find hot spots in
+// FreeType drivers while interacting with a slow font.  A `SIGPROF` timer
+// fires for every `1 / frequency` seconds of consumed CPU time and the
+// signal handler records the stack of the interrupted thread (the GUI
+// thread or a render worker).  Stacks are symbolized in-process only when
+// exported, as 'folded' stacks that flame graph tools (e.g.,
+// `flamegraph.pl` or speedscope) read directly.
+//
+// Only available on Linux.  Function names are taken from the ELF symbol
+// tables of the executable and the shared libraries, including hidden and
+// local functions like most of FreeType's internals.  For stripped modules
+// only exported functions have names (the build files export those of the
+// executable); other frames are written as `module+0xoffset`, which
+// `addr2line -f -e <module> <offset>` resolves given the unstripped file.
+class SamplingProfiler
+{
+public:
+  static bool available();
+
+  // All samples of a previous run are discarded.
+  static bool start(int frequency = DefaultFrequency);
+  static void stop();
+  static bool running();
+
+  static int sampleCount();
+  // Samples lost since the buffer was full.
+  static int droppedSampleCount();
+
+  // One line per distinct stack: the frames from the outermost to the
+  // innermost one, separated by semicolons, followed by the number of
+  // samples.
+  static bool writeFoldedStacks(QString const& filePath);
+
+  constexpr static int DefaultFrequency = 997; // Avoid lockstep with timers.
+};
+
+
+// end of profiler.hpp
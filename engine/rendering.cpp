@@ -6,7 +6,10 @@
 #include "engine.hpp"
 #include "rendering.hpp"
 
+#include <algorithm>
+#include <climits>
 #include <cmath>
+#include <tuple>
 
 #include <QPainter>
 #include <QPixmap>
@@ -292,6 +295,92 @@ RenderingEngine::convertGlyphToQImage(FT_Glyph src,
 }
 
 
+QImage*
+RenderingEngine::convertGlyphToQImageClipped(FT_Glyph src,
+                                             QRect clip,
+                                             QRect* outRect)
+{
+  if (src->format != FT_GLYPH_FORMAT_OUTLINE)
+    return convertGlyphToQImage(src, outRect, true);
+
+  auto renderMode = engine_->renderMode();
+  if (renderMode != FT_RENDER_MODE_NORMAL
+      && renderMode != FT_RENDER_MODE_LIGHT
+      && renderMode != FT_RENDER_MODE_MONO)
+    return NULL;
+
+  auto outline = &reinterpret_cast<FT_OutlineGlyph>(src)->outline;
+  FT_BBox cbox;
+  FT_Outline_Get_CBox(outline, &cbox);
+  cbox.xMin &= ~63;
+  cbox.yMin &= ~63;
+  cbox.xMax = (cbox.xMax + 63) & ~63;
+  cbox.yMax = (cbox.yMax + 63) & ~63;
+  QRect glyphRect(static_cast<int>(cbox.xMin / 64),
+                  static_cast<int>(-cbox.yMax / 64),
+                  static_cast<int>((cbox.xMax - cbox.xMin) / 64),
+                  static_cast<int>((cbox.yMax - cbox.yMin) / 64));
+  clip &= glyphRect;
+  if (clip.isEmpty())
+    return NULL;
+
+  FT_Bitmap bitmap;
+  FT_Bitmap_Init(&bitmap);
+  bitmap.width = static_cast<unsigned>(clip.width());
+  bitmap.rows = static_cast<unsigned>(clip.height());
+  if (renderMode == FT_RENDER_MODE_MONO)
+  {
+    bitmap.pixel_mode = FT_PIXEL_MODE_MONO;
+    bitmap.pitch = (clip.width() + 7) / 8;
+  }
+  else
+  {
+    bitmap.pixel_mode = FT_PIXEL_MODE_GRAY;
+    bitmap.num_grays = 256;
+    bitmap.pitch = clip.width();
+  }
+  std::vector<unsigned char> buffer(static_cast<size_t>(bitmap.pitch)
+                                    * bitmap.rows);
+  bitmap.buffer = buffer.data();
+
+  // The rasterizers never draw outside of the target bitmap and skip the
+  // rest of the outline early, so move the clip box onto the bitmap.  The
+  // shift is by whole pixels and undone exactly.
+  FT_Pos dx = -clip.left() * 64;
+  FT_Pos dy = (clip.top() + clip.height()) * 64;
+  FT_Outline_Translate(outline, dx, dy);
+  auto error = FT_Outline_Get_Bitmap(engine_->ftLibrary(), outline, &bitmap);
+  FT_Outline_Translate(outline, -dx, -dy);
+  if (error)
+    return NULL;
+
+  auto result = convertBitmapToQImage(&bitmap);
+  if (result && outRect)
+    *outRect = clip;
+
+  return result;
+}
+
+
+bool
+RenderingEngine::retintImage(QImage* image)
+{
+  switch (image->format())
+  {
+  case QImage::Format_Indexed8:
+    image->setColorTable(foregroundTable_);
+    return true;
+  case QImage::Format_Mono:
+    image->setColor(1, foregroundTable_[0xFF]);
+    return true;
+  case QImage::Format_ARGB32_Premultiplied:
+    return true; // Color bitmaps don't use the foreground color.
+  default:
+    return false;
+  }
+}
+
+
 QPoint
 RenderingEngine::computeGlyphOffset(FT_Glyph glyph,
                                     bool inverseY)
@@ -322,6 +411,55 @@ RenderingEngine::computeGlyphOffset(FT_Glyph glyph,
 }
 
 
+bool
+RenderingEngine::ColorGlyphKey::operator<(const ColorGlyphKey& other) const
+{
+  return std::tie(faceID, width, height, flags, glyphIndex)
+         < std::tie(other.faceID, other.width, other.height, other.flags,
+                    other.glyphIndex);
+}
+
+
+namespace
+{
+
+// Source-over blending of a layer in `color` onto premultiplied BGRA
+// pixels, with the same arithmetic as `FT_Bitmap_Blend`.  The loop has no
+// branches so that compilers can vectorize it.
+void
+blendColorLayer(const unsigned char* coverage,
+                int width,
+                int height,
+                FT_Color color,
+                QImage& image,
+                int x,
+                int y)
+{
+  for (int row = 0; row < height; row++)
+  {
+    auto src = coverage + row * width;
+    auto dst = image.scanLine(y + row) + x * 4;
+
+    for (int col = 0; col < width; col++)
+    {
+      int fa = color.alpha * src[col] / 255;
+      int fb = color.blue * fa / 255;
+      int fg = color.green * fa / 255;
+      int fr = color.red * fa / 255;
+      int ba2 = 255 - fa;
+
+      auto pixel = dst + col * 4;
+      pixel[0] = static_cast<unsigned char>(pixel[0] * ba2 / 255 + fb);
+      pixel[1] = static_cast<unsigned char>(pixel[1] * ba2 / 255 + fg);
+      pixel[2] = static_cast<unsigned char>(pixel[2] * ba2 / 255 + fr);
+      pixel[3] = static_cast<unsigned char>(pixel[3] * ba2 / 255 + fa);
+    }
+  }
+}
+
+} // namespace
+
+
 QImage*
 RenderingEngine::tryDirectRenderColorLayers(int glyphIndex,
                                             QRect* outRect,
@@ -335,6 +473,98 @@ RenderingEngine::tryDirectRenderColorLayers(int glyphIndex,
       || paletteIndex >= paletteData.num_palettes)
     return NULL;
 
+  auto colorGlyph = loadColorGlyph(glyphIndex);
+  if (!colorGlyph)
+    return NULL;
+
+  auto img = new QImage(colorGlyph->width, colorGlyph->height,
+                        QImage::Format_ARGB32_Premultiplied);
+  img->fill(Qt::transparent);
+
+  for (auto& layer : colorGlyph->layers)
+  {
+    FT_Color color = {};
+
+    if (layer.colorIndex == 0xFFFF)
+    {
+      // TODO: FT_Palette_Get_Foreground_Color: #1134
+      if (paletteData.palette_flags
+          && (paletteData.palette_flags[paletteIndex]
+              & FT_PALETTE_FOR_DARK_BACKGROUND))
+      {
+        /* white opaque */
+        color.blue = 0xFF;
+        color.green = 0xFF;
+        color.red = 0xFF;
+        color.alpha = 0xFF;
+      }
+      else
+      {
+        /* black opaque */
+        color.blue = 0x00;
+        color.green = 0x00;
+        color.red = 0x00;
+        color.alpha = 0xFF;
+      }
+    }
+    else if (layer.colorIndex < paletteData.num_palette_entries)
+      color = palette[layer.colorIndex];
+    else
+      continue;
+
+    blendColorLayer(layer.coverage.data(), layer.width, layer.height,
+                    color, *img, layer.x, layer.y);
+  }
+
+  if (outRect)
+  {
+    outRect->moveLeft(colorGlyph->left);
+    if (inverseRectY)
+      outRect->moveTop(-colorGlyph->top);
+    else
+      outRect->moveTop(colorGlyph->top);
+    outRect->setSize(img->size());
+  }
+
+  return img;
+}
+
+
+void
+RenderingEngine::clearColorGlyphCache()
+{
+  colorGlyphCache_.clear();
+  colorGlyphCacheBytes_ = 0;
+}
+
+
+RenderingEngine::ColorGlyph*
+RenderingEngine::loadColorGlyph(int glyphIndex)
+{
+  // Layers are rendered without `FT_LOAD_COLOR` in normal mode.
+  auto imageType = engine_->imageType();
+  auto oldLoadFlags = imageType->flags;
+  auto loadFlags = oldLoadFlags;
+  loadFlags &= ~FT_LOAD_COLOR;
+  loadFlags |= FT_LOAD_RENDER;
+
+  loadFlags &= ~FT_LOAD_TARGET_(0xF);
+  loadFlags |= FT_LOAD_TARGET_NORMAL;
+
+  ColorGlyphKey key = { imageType->face_id,
+                        imageType->width,
+                        imageType->height,
+                        loadFlags,
+                        glyphIndex };
+  auto it = colorGlyphCache_.find(key);
+  if (it != colorGlyphCache_.end())
+    return it->layers.empty() ? NULL : &it.value();
+
+  if (colorGlyphCacheBytes_ > ColorGlyphCacheMaxBytes)
+    clearColorGlyphCache();
+
+  auto& colorGlyph = colorGlyphCache_[key];
+
   FT_LayerIterator iter = {};
 
   FT_UInt layerGlyphIdx = 0;
@@ -349,31 +579,25 @@ RenderingEngine::tryDirectRenderColorLayers(int glyphIndex,
     return NULL;
 
   // Temporarily change load flags.
-  auto imageType = engine_->imageType();
-  auto oldLoadFlags = imageType->flags;
-  auto loadFlags = oldLoadFlags;
-  loadFlags &= ~FT_LOAD_COLOR;
-  loadFlags |= FT_LOAD_RENDER;
-
-  loadFlags &= ~FT_LOAD_TARGET_(0xF);
-  loadFlags |= FT_LOAD_TARGET_NORMAL;
   imageType->flags = loadFlags;
 
-  FT_Bitmap bitmap = {};
-  FT_Bitmap_Init(&bitmap);
+  FT_Bitmap converted;
+  FT_Bitmap_Init(&converted);
 
-  FT_Vector bitmapOffset = {};
+  // Bounding box of all layers, in pixels.
+  int xMin = INT_MAX;
+  int yMax = INT_MIN;
+  int xMax = INT_MIN;
+  int yMin = INT_MAX;
   bool failed = false;
 
   do
   {
-    FT_Vector slotOffset;
-    FT_Glyph glyph;
-    if (FTC_ImageCache_Lookup(engine_->imageCacheManager(),
-                              imageType,
-                              layerGlyphIdx,
-                              &glyph,
-                              NULL))
+    // This applies the glyph budgets; a rejected layer is remembered under
+    // its own glyph index.
+    auto glyph = engine_->loadGlyphWithoutUpdate(
+                   static_cast<int>(layerGlyphIdx));
+    if (!glyph)
     {
       // XXX Error handling
       failed = true;
@@ -384,47 +608,45 @@ RenderingEngine::tryDirectRenderColorLayers(int glyphIndex,
       continue;
 
     auto bitmapGlyph = reinterpret_cast<FT_BitmapGlyph>(glyph);
-    slotOffset.x = bitmapGlyph->left << 6;
-    slotOffset.y = bitmapGlyph->top << 6;
-
-    FT_Color color = {};
+    auto bitmap = &bitmapGlyph->bitmap;
+    if (bitmap->pixel_mode == FT_PIXEL_MODE_NONE
+        || !bitmap->width || !bitmap->rows)
+      continue;
 
-    if (layerColorIdx == 0xFFFF)
+    if (bitmap->pixel_mode != FT_PIXEL_MODE_GRAY)
     {
-      // TODO: FT_Palette_Get_Foreground_Color: #1134
-      if (paletteData.palette_flags
-          && (paletteData.palette_flags[paletteIndex]
-              & FT_PALETTE_FOR_DARK_BACKGROUND))
-      {
-        /* white opaque */
-        color.blue = 0xFF;
-        color.green = 0xFF;
-        color.red = 0xFF;
-        color.alpha = 0xFF;
-      }
-      else
+      if (FT_Bitmap_Convert(engine_->ftLibrary(), bitmap, &converted, 1))
       {
-        /* black opaque */
-        color.blue = 0x00;
-        color.green = 0x00;
-        color.red = 0x00;
-        color.alpha = 0xFF;
+        failed = true;
+        break;
       }
+      bitmap = &converted;
     }
-    else if (layerColorIdx < paletteData.num_palette_entries)
-      color = palette[layerColorIdx];
-    else
-      continue;
-
-    if (FT_Bitmap_Blend(engine_->ftLibrary(),
-                        &bitmapGlyph->bitmap, slotOffset,
-                        &bitmap, &bitmapOffset,
-                        color))
+    if (bitmap->pitch < 0) // Not produced by FreeType's renderers.
     {
-      // XXX error
       failed = true;
       break;
     }
+
+    colorGlyph.layers.emplace_back();
+    auto& layer = colorGlyph.layers.back();
+    layer.x = bitmapGlyph->left;
+    layer.y = bitmapGlyph->top;
+    layer.width = static_cast<int>(bitmap->width);
+    layer.height = static_cast<int>(bitmap->rows);
+    layer.colorIndex = layerColorIdx;
+
+    layer.coverage.resize(static_cast<size_t>(layer.width) * layer.height);
+    for (int row = 0; row < layer.height; row++)
+      std::copy_n(bitmap->buffer + row * bitmap->pitch,
+                  layer.width,
+                  layer.coverage.begin() + row * layer.width);
+    colorGlyphCacheBytes_ += layer.coverage.size();
+
+    xMin = std::min(xMin, layer.x);
+    xMax = std::max(xMax, layer.x + layer.width);
+    yMax = std::max(yMax, layer.y);
+    yMin = std::min(yMin, layer.y - layer.height);
   } while (FT_Get_Color_Glyph_Layer(engine_->currentFtSize()->face,
                                     glyphIndex,
                                     &layerGlyphIdx,
@@ -432,25 +654,60 @@ RenderingEngine::tryDirectRenderColorLayers(int glyphIndex,
                                     &iter));
 
   imageType->flags = oldLoadFlags;
-  if (failed)
+  FT_Bitmap_Done(engine_->ftLibrary(), &converted);
+
+  if (failed || colorGlyph.layers.empty())
   {
-    FT_Bitmap_Done(engine_->ftLibrary(), &bitmap);
+    colorGlyph.layers.clear();
     return NULL;
   }
 
+  // Make layer positions relative to the top-left corner.
+  for (auto& layer : colorGlyph.layers)
+  {
+    layer.x -= xMin;
+    layer.y = yMax - layer.y;
+  }
+  colorGlyph.left = xMin;
+  colorGlyph.top = yMax;
+  colorGlyph.width = xMax - xMin;
+  colorGlyph.height = yMax - yMin;
+
+  return &colorGlyph;
+}
+
+
+QImage*
+RenderingEngine::tryDirectRenderSBit(int glyphIndex,
+                                     QRect* outRect,
+                                     bool inverseRectY)
+{
+  auto sbit = engine_->loadSBitWithoutUpdate(glyphIndex);
+  if (!sbit)
+    return NULL;
+
+  FT_Bitmap bitmap;
+  FT_Bitmap_Init(&bitmap);
+  bitmap.width = sbit->width;
+  bitmap.rows = sbit->height;
+  bitmap.pitch = sbit->pitch;
+  bitmap.buffer = sbit->buffer;
+  bitmap.num_grays = static_cast<unsigned short>(sbit->max_grays + 1);
+  bitmap.pixel_mode = sbit->format;
+
+  // `bitmap` is only a view of the cache data; don't free it.
   auto img = convertBitmapToQImage(&bitmap);
-  if (outRect)
+  if (img && outRect)
   {
-    outRect->moveLeft(static_cast<int>(bitmapOffset.x >> 6));
+    outRect->setLeft(sbit->left);
     if (inverseRectY)
-      outRect->moveTop(static_cast<int>(-bitmapOffset.y >> 6));
+      outRect->setTop(-sbit->top);
     else
-      outRect->moveTop(static_cast<int>(bitmapOffset.y >> 6));
-    outRect->setSize(img->size());
+      outRect->setTop(sbit->top);
+    outRect->setWidth(sbit->width);
+    outRect->setHeight(sbit->height);
   }
 
-  FT_Bitmap_Done(engine_->ftLibrary(), &bitmap);
-
   return img;
 }
 
@@ -5,10 +5,14 @@
 
 #pragma once
 
+#include <vector>
+
 #include <QColor>
 #include <QImage>
+#include <QMap>
 
 #include <freetype/freetype.h>
+#include <freetype/ftcache.h>
 #include <freetype/ftglyph.h>
 
 
@@ -38,6 +42,21 @@ public:
   QImage* convertGlyphToQImage(FT_Glyph src,
                                QRect* outRect,
                                bool inverseRectY);
+  // Like `convertGlyphToQImage` with `inverseRectY` set, but rasterize only
+  // the part of an outline glyph inside `clip` (in pixels relative to the
+  // glyph origin, y axis pointing down), so the time and memory needed are
+  // bounded by the size of `clip` instead of the glyph.  Only for the
+  // monochrome and gray-level render modes; the LCD filter needs the
+  // neighbours of every pixel.  Return NULL if nothing is left after
+  // clipping or the render mode isn't supported.
+  QImage* convertGlyphToQImageClipped(FT_Glyph src,
+                                      QRect clip,
+                                      QRect* outRect);
+  // Apply the current foreground color, background color, and gamma to an
+  // image created by `convertBitmapToQImage` without rendering it again.
+  // Return `false` if this is not possible (LCD images store blended colors
+  // only).
+  bool retintImage(QImage* image);
   QPoint computeGlyphOffset(FT_Glyph glyph,
                             bool inverseY);
 
@@ -46,16 +65,72 @@ public:
   // the glyph and do normal rendering.  If the return value is non-NULL
   // there is no need to load the glyph the normal way, just draw the
   // `QImage`.  Return NULL if not enabled or color layers not available.
+  //
+  // The coverage masks of the layers are cached, so switching palettes only
+  // recomposites them.
   QImage* tryDirectRenderColorLayers(int glyphIndex,
                                      QRect* outRect,
                                      bool inverseRectY = false);
+  // Must be called when the FreeType cache is reset.
+  void clearColorGlyphCache();
+
+  // Convert the glyph at the specified index to a `QImage`, taking the
+  // pre-rendered bitmap from the small bitmap cache.  This skips creating
+  // and rendering an `FT_Glyph` object, thus the glyph can't be transformed.
+  // Return NULL if the glyph isn't available from the cache.
+  QImage* tryDirectRenderSBit(int glyphIndex,
+                              QRect* outRect,
+                              bool inverseRectY = false);
 
   QPixmap padToSize(QImage* image,
                     int ppem);
 
 private:
+  // One layer of a color glyph: an 8-bit coverage mask (without padding)
+  // positioned relative to the top-left corner of the whole glyph, and the
+  // palette index to paint it with.
+  struct ColorLayer
+  {
+    std::vector<unsigned char> coverage;
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+    unsigned colorIndex = 0;
+  };
+
+  // `left` and `top` are the bitmap offsets of the whole glyph.  No layers
+  // means that the glyph has no color layers or can't be loaded.
+  struct ColorGlyph
+  {
+    std::vector<ColorLayer> layers;
+    int left = 0;
+    int top = 0;
+    int width = 0;
+    int height = 0;
+  };
+
+  struct ColorGlyphKey
+  {
+    FTC_FaceID faceID;
+    FT_UInt width;
+    FT_UInt height;
+    FT_Int32 flags;
+    int glyphIndex;
+
+    bool operator<(const ColorGlyphKey& other) const;
+  };
+
+  // Flush the cache if it grows beyond this size.
+  constexpr static size_t ColorGlyphCacheMaxBytes = 32 * 1024 * 1024;
+
   Engine* engine_;
 
+  QMap<ColorGlyphKey, ColorGlyph> colorGlyphCache_;
+  size_t colorGlyphCacheBytes_ = 0;
+
+  ColorGlyph* loadColorGlyph(int glyphIndex);
+
   QRgb backgroundColor_ = 0;
   QRgb foregroundColor_ = 0;
   double gamma_ = 1.8;
@@ -0,0 +1,150 @@
+// renderscheduler.cpp
+
+// Copyright (C) 2022-2023 by
+// Charlie Jiang.
+
+#include "renderscheduler.hpp"
+
+#include <algorithm>
+
+#include <QMetaObject>
+#include <QMutexLocker>
+#include <QThread>
+
+
+RenderScheduler::RenderScheduler()
+: maxThreads_(qMax(QThread::idealThreadCount(), 1))
+{
+  pool_.setMaxThreadCount(maxThreads_);
+}
+
+
+RenderScheduler::~RenderScheduler()
+{
+  {
+    QMutexLocker locker(&mutex_);
+    for (auto& queue : queues_)
+      queue.clear();
+  }
+  pool_.waitForDone();
+}
+
+
+void
+RenderScheduler::submit(QObject* context,
+                        Priority priority,
+                        Job job)
+{
+  QMutexLocker locker(&mutex_);
+  queues_[priority].push_back({ context, generations_.value(context),
+                                std::move(job) });
+  dispatch();
+}
+
+
+void
+RenderScheduler::cancel(QObject* context)
+{
+  QMutexLocker locker(&mutex_);
+  generations_[context]++;
+  for (auto& queue : queues_)
+    queue.erase(std::remove_if(queue.begin(), queue.end(),
+                               [context](Task const& task)
+                               {
+                                 return task.context == context;
+                               }),
+                queue.end());
+}
+
+
+void
+RenderScheduler::remove(QObject* context)
+{
+  cancel(context);
+
+  QMutexLocker locker(&mutex_);
+  while (runningTasks_.value(context) > 0)
+    taskFinished_.wait(&mutex_);
+  generations_.remove(context);
+}
+
+
+// Start as many queued tasks as there are free threads.  Call with `mutex_`
+// locked.
+void
+RenderScheduler::dispatch()
+{
+  while (runningCount_ < maxThreads_)
+  {
+    int priority;
+    if (!queues_[P_Visible].empty())
+      priority = P_Visible;
+    else if (!queues_[P_Prefetch].empty())
+      priority = P_Prefetch;
+    else if (!queues_[P_Background].empty()
+             && (runningBackground_ < maxThreads_ - 1 || maxThreads_ == 1))
+      priority = P_Background; // Keep a thread free for visible work.
+    else
+      break;
+
+    auto task = std::move(queues_[priority].front());
+    queues_[priority].pop_front();
+
+    runningCount_++;
+    runningTasks_[task.context]++;
+    if (priority == P_Background)
+      runningBackground_++;
+
+    pool_.start([this, task, priority]
+                {
+                  run(task, static_cast<Priority>(priority));
+                });
+  }
+}
+
+
+void
+RenderScheduler::run(Task task,
+                     Priority priority)
+{
+  bool current;
+  {
+    QMutexLocker locker(&mutex_);
+    current = generations_.value(task.context) == task.generation;
+  }
+
+  Completion completion;
+  if (current)
+    completion = task.job();
+  task.job = nullptr; // Free captured resources in this thread.
+
+  if (completion)
+  {
+    auto context = task.context;
+    auto generation = task.generation;
+    QMetaObject::invokeMethod(
+      context,
+      [this, context, generation, completion]
+      {
+        {
+          QMutexLocker locker(&mutex_);
+          if (generations_.value(context) != generation)
+            return; // Cancelled while in flight.
+        }
+        completion();
+      },
+      Qt::QueuedConnection);
+  }
+
+  QMutexLocker locker(&mutex_);
+  runningCount_--;
+  if (priority == P_Background)
+    runningBackground_--;
+  if (--runningTasks_[task.context] == 0)
+    runningTasks_.remove(task.context);
+  taskFinished_.wakeAll();
+  dispatch();
+}
+
+
+// end of renderscheduler.cpp
@@ -0,0 +1,84 @@
+// renderscheduler.hpp
+
+// Copyright (C) 2022-2023 by
+// Charlie Jiang.
+
+#pragma once
+
+#include <deque>
+#include <functional>
+
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QThreadPool>
+#include <QWaitCondition>
+
+
+// A worker pool shared by all views for rendering and analysis work that
+// runs off the GUI thread.  Jobs are queued by priority: what the user is
+// looking at comes before prefetching, and prefetching before background
+// analysis, which never occupies all threads.
+//
+// Each job belongs to a context object, usually its submitter.  When the
+// inputs of a context change (e.g., its settings), `cancel` drops the
+// context's queued jobs and the results of its running ones: a job records
+// the context's generation number when submitted, and it is discarded once
+// the number is outdated, both before it starts and before its completion
+// is delivered.  Completions are called in the context's (GUI) thread.
+class RenderScheduler
+{
+public:
+  enum Priority : int
+  {
+    P_Visible,
+    P_Prefetch,
+    P_Background
+  };
+
+  // A job does its work in a worker thread and returns a completion to be
+  // called with the results in the context's thread (or an empty one).
+  // FreeType objects must not be shared with the GUI thread; use a private
+  // `FT_Library` object per job.
+  using Completion = std::function<void()>;
+  using Job = std::function<Completion()>;
+
+  RenderScheduler();
+  ~RenderScheduler();
+
+  void submit(QObject* context,
+              Priority priority,
+              Job job);
+  // Drop all queued jobs and undelivered results of `context`.
+  void cancel(QObject* context);
+  // Like `cancel`, but also wait for running jobs of `context` to finish;
+  // call this before destroying `context`.
+  void remove(QObject* context);
+
+private:
+  struct Task
+  {
+    QObject* context;
+    unsigned generation;
+    Job job;
+  };
+
+  QThreadPool pool_;
+  int maxThreads_;
+
+  // Everything below is guarded by `mutex_`.
+  QMutex mutex_;
+  QWaitCondition taskFinished_;
+  std::deque<Task> queues_[P_Background + 1];
+  QHash<QObject*, unsigned> generations_;
+  QHash<QObject*, int> runningTasks_; // Per context.
+  int runningCount_ = 0;
+  int runningBackground_ = 0;
+
+  void dispatch();
+  void run(Task task,
+           Priority priority);
+};
+
+
+// end of renderscheduler.hpp
@@ -0,0 +1,302 @@
+// renderservice.cpp
+
+// Copyright (C) 2022-2023 by
+// Charlie Jiang.
+
+#include "engine.hpp"
+#include "renderservice.hpp"
+
+#include <algorithm>
+#include <tuple>
+
+#include <QBuffer>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QTimer>
+
+#include <freetype/ftglyph.h>
+
+
+namespace
+{
+
+constexpr double DefaultPixelSize = 16;
+
+
+void
+sendReply(QLocalSocket* client,
+          QJsonObject const& reply)
+{
+  client->write(QJsonDocument(reply).toJson(QJsonDocument::Compact));
+  client->write("\n");
+}
+
+
+QJsonObject
+failure(QString const& message)
+{
+  return { { "ok", false }, { "error", message } };
+}
+
+
+std::tuple<QString, int, int>
+fontKey(QJsonObject const& request)
+{
+  return std::make_tuple(request["font"].toString(),
+                         request["face"].toInt(),
+                         request["instance"].toInt());
+}
+
+} // namespace
+
+
+RenderService::RenderService(QObject* parent,
+                             Engine* engine)
+: QObject(parent),
+  engine_(engine)
+{
+  server_ = new QLocalServer(this);
+  connect(server_, &QLocalServer::newConnection,
+          this, &RenderService::acceptConnections);
+}
+
+
+bool
+RenderService::listen(QString const& socketPath)
+{
+  QLocalServer::removeServer(socketPath); // Left over by a crash.
+  return server_->listen(socketPath);
+}
+
+
+void
+RenderService::acceptConnections()
+{
+  while (auto client = server_->nextPendingConnection())
+  {
+    connect(client, &QLocalSocket::readyRead,
+            this, &RenderService::readRequests);
+    connect(client, &QLocalSocket::disconnected,
+            client, &QObject::deleteLater);
+  }
+}
+
+
+void
+RenderService::readRequests()
+{
+  auto client = qobject_cast<QLocalSocket*>(sender());
+  if (!client)
+    return;
+
+  auto batchStarted = !pending_.empty();
+  while (client->canReadLine())
+  {
+    auto line = client->readLine().trimmed();
+    if (line.isEmpty())
+      continue;
+
+    QJsonParseError error;
+    auto document = QJsonDocument::fromJson(line, &error);
+    if (!document.isObject())
+    {
+      sendReply(client,
+                failure(error.error != QJsonParseError::NoError
+                          ? error.errorString()
+                          : QString("request is not an object")));
+      continue;
+    }
+    pending_.push_back({ client, document.object() });
+  }
+
+  // Served once the event loop has delivered the data of all clients.
+  if (!batchStarted && !pending_.empty())
+    QTimer::singleShot(0, this, &RenderService::serveBatch);
+}
+
+
+void
+RenderService::serveBatch()
+{
+  std::vector<Request> batch;
+  batch.swap(pending_);
+
+  std::stable_sort(batch.begin(), batch.end(),
+                   [](Request const& a,
+                      Request const& b)
+                   {
+                     return fontKey(a.object) < fontKey(b.object);
+                   });
+
+  for (auto& request : batch)
+  {
+    auto reply = serve(request.object);
+    if (request.object.contains("id"))
+      reply["id"] = request.object["id"];
+    if (request.client) // Not yet disconnected.
+      sendReply(request.client, reply);
+  }
+}
+
+
+QJsonObject
+RenderService::serve(QJsonObject const& request)
+{
+  auto command = request["command"].toString();
+  if (command != "info" && command != "metrics" && command != "render")
+    return failure(QString("unknown command '%1'").arg(command));
+
+  auto fontIndex = fontIndexFor(request["font"].toString());
+  if (fontIndex < 0)
+    return failure("can't open font file");
+
+  auto faceIndex = request["face"].toInt();
+  auto instanceIndex = request["instance"].toInt();
+  auto numFaces = engine_->numberOfFaces(fontIndex);
+  auto numInstances = engine_->numberOfNamedInstances(fontIndex, faceIndex);
+
+  engine_->setSizeByPixel(request["size"].toDouble(DefaultPixelSize));
+  engine_->setHinting(request["hinting"].toBool(true));
+  // The same as the settings panel's `Normal` and `None` modes.
+  auto antiAliasing = request["antialiasing"].toBool(true);
+  engine_->setAntiAliasingTarget(antiAliasing ? FT_LOAD_TARGET_NORMAL
+                                              : FT_LOAD_TARGET_MONO);
+  engine_->setRenderMode(antiAliasing ? FT_RENDER_MODE_NORMAL
+                                      : FT_RENDER_MODE_MONO);
+  engine_->setAntiAliasingEnabled(antiAliasing);
+  if (engine_->loadFont(fontIndex, faceIndex, instanceIndex) < 0)
+    return failure("can't load face");
+
+  if (command == "info")
+  {
+    auto face = engine_->currentFallbackFtFace();
+    QJsonArray fixedSizes;
+    for (auto size : engine_->currentFontFixedSizes())
+      fixedSizes.append(size);
+
+    return { { "ok", true },
+             { "family", engine_->currentFamilyName() },
+             { "style", engine_->currentStyleName() },
+             { "faces", static_cast<int>(numFaces) },
+             { "namedInstances", numInstances - 1 },
+             { "glyphs", engine_->currentFontNumberOfGlyphs() },
+             { "unitsPerEM", static_cast<int>(face->units_per_EM) },
+             { "scalable", FT_IS_SCALABLE(face) != 0 },
+             { "fixedSizes", fixedSizes } };
+  }
+
+  if (!engine_->renderReady())
+    return failure("can't set up the requested size");
+
+  // `ascender` and friends are given in 26.6 fractional pixels.
+  auto& metrics = engine_->currentFontMetrics();
+  return { { "ok", true },
+           { "ascender", metrics.ascender / 64.0 },
+           { "descender", metrics.descender / 64.0 },
+           { "height", metrics.height / 64.0 },
+           { "glyphs", glyphResults(requestedGlyphs(request),
+                                    command == "render") } };
+}
+
+
+int
+RenderService::fontIndexFor(QString const& filePath)
+{
+  if (filePath.isEmpty())
+    return -1;
+
+  // Fonts stay open (and their faces cached) for later requests.
+  auto absPath = QFileInfo(filePath).absoluteFilePath();
+  auto& manager = engine_->fontFileManager();
+  for (int i = 0; i < manager.size(); i++)
+    if (manager[i].absoluteFilePath() == absPath)
+      return i;
+
+  // Invalid files are skipped by `append`.
+  manager.append({ absPath }, false);
+  auto last = manager.size() - 1;
+  if (last >= 0 && manager[last].absoluteFilePath() == absPath)
+    return last;
+  return -1;
+}
+
+
+std::vector<int>
+RenderService::requestedGlyphs(QJsonObject const& request)
+{
+  std::vector<int> glyphs;
+  if (request.contains("text"))
+  {
+    auto charMap = engine_->currentFontFirstUnicodeCharMap();
+    for (auto code : request["text"].toString().toUcs4())
+      glyphs.push_back(static_cast<int>(
+        engine_->glyphIndexFromCharCode(static_cast<int>(code), charMap)));
+  }
+  else
+    for (auto value : request["glyphs"].toArray())
+      glyphs.push_back(value.toInt(-1));
+
+  return glyphs;
+}
+
+
+QJsonArray
+RenderService::glyphResults(std::vector<int> const& glyphIndices,
+                            bool render)
+{
+  QJsonArray results;
+  auto numGlyphs = engine_->currentFontNumberOfGlyphs();
+  for (auto index : glyphIndices)
+  {
+    QJsonObject entry{ { "index", index } };
+
+    // The glyph is owned by the cache.
+    FT_Glyph glyph = NULL;
+    if (index >= 0 && index < numGlyphs)
+      glyph = engine_->loadGlyph(index);
+    if (!glyph)
+    {
+      auto error = engine_->glyphError(index);
+      entry["error"] = error.isEmpty() ? QString("can't load glyph") : error;
+      results.append(entry);
+      continue;
+    }
+
+    // The advance of an `FT_Glyph` is in 16.16 format.
+    entry["advance"] = QJsonArray{ glyph->advance.x / 65536.0,
+                                   glyph->advance.y / 65536.0 };
+    FT_BBox box;
+    FT_Glyph_Get_CBox(glyph, FT_GLYPH_BBOX_PIXELS, &box);
+    entry["bbox"] = QJsonArray{ static_cast<int>(box.xMin),
+                                static_cast<int>(box.yMin),
+                                static_cast<int>(box.xMax),
+                                static_cast<int>(box.yMax) };
+
+    if (render)
+    {
+      QRect rect;
+      auto image = engine_->renderingEngine()->convertGlyphToQImage(glyph,
+                                                                    &rect,
+                                                                    false);
+      if (image)
+      {
+        QByteArray png;
+        QBuffer buffer(&png);
+        buffer.open(QIODevice::WriteOnly);
+        image->save(&buffer, "PNG");
+        delete image;
+
+        entry["left"] = rect.left();
+        entry["top"] = rect.top();
+        entry["png"] = QString::fromLatin1(png.toBase64());
+      }
+    }
+
+    results.append(entry);
+  }
+
+  return results;
+}
+
+
+// end of renderservice.cpp
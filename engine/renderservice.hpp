@@ -0,0 +1,82 @@
+// renderservice.hpp
+
+// Copyright (C) 2022-2023 by
+// Charlie Jiang.
+
+#pragma once
+
+#include <vector>
+
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QObject>
+#include <QPointer>
+
+
+class Engine;
+
+// Headless mode (`ftinspect --serve <socket>`): answer requests of other
+// programs, e.g., a build pipeline, over a local (UNIX domain) socket.  The
+// engine stays alive between requests, so opened fonts, faces, and glyph
+// caches are reused instead of being set up for each job.
+//
+// The protocol is line-based JSON; each request is an object on a line of
+// its own and gets exactly one reply line.
+//
+//   {"id": 1, "command": "render", "font": "/path/a.ttf", "face": 0,
+//    "instance": 0, "size": 16, "hinting": true, "antialiasing": true,
+//    "text": "abc"}
+//
+// `command` is `info`, `metrics`, or `render`.  Glyphs are given either as
+// `text` (mapped through the first Unicode charmap) or as an array of glyph
+// indices in `glyphs`.  `size` is in pixels.  Replies carry the request's
+// `id` and either `"ok": true` with the results or `"ok": false` with an
+// `error` string.  Rendered glyphs are base64-encoded PNG images; without
+// anti-aliasing, these are 1-bit images.
+//
+// Requests arriving together (from all clients) are sorted by font before
+// they are served, so that each font is set up once per batch; clients thus
+// have to match replies by `id`.
+class RenderService
+: public QObject
+{
+  Q_OBJECT
+
+public:
+  RenderService(QObject* parent,
+                Engine* engine);
+  ~RenderService() override = default;
+
+  // An existing socket file is replaced.
+  bool listen(QString const& socketPath);
+  QString errorString() { return server_->errorString(); }
+
+  constexpr static const char* ServeArgument = "--serve";
+
+private slots:
+  void acceptConnections();
+  void readRequests();
+  void serveBatch();
+
+private:
+  struct Request
+  {
+    QPointer<QLocalSocket> client;
+    QJsonObject object;
+  };
+
+  Engine* engine_;
+  QLocalServer* server_;
+  std::vector<Request> pending_;
+
+  QJsonObject serve(QJsonObject const& request);
+  int fontIndexFor(QString const& filePath);
+  QJsonArray glyphResults(std::vector<int> const& glyphIndices,
+                          bool render);
+  std::vector<int> requestedGlyphs(QJsonObject const& request);
+};
+
+
+// end of renderservice.hpp
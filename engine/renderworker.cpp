@@ -0,0 +1,516 @@
+// renderworker.cpp
+
+// Copyright (C) 2022-2023 by
+// Charlie Jiang.
+
+#include "renderworker.hpp"
+
+#include <QDataStream>
+#include <QFileInfo>
+#include <QMutexLocker>
+
+#ifdef Q_OS_LINUX
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+
+#ifdef Q_OS_LINUX
+
+namespace
+{
+
+// Requests and replies are small; anything larger is a protocol error.
+constexpr quint32 MaxMessageSize = 1 << 20;
+
+enum IOResult : int
+{
+  IO_Ok,
+  IO_Error, // Includes the peer being gone.
+  IO_Timeout
+};
+
+
+IOResult
+waitReadable(int fd,
+             int timeoutMs)
+{
+  pollfd pfd = { fd, POLLIN, 0 };
+  int ret;
+  do
+    ret = poll(&pfd, 1, timeoutMs);
+  while (ret < 0 && errno == EINTR);
+
+  if (ret == 0)
+    return IO_Timeout;
+  return ret > 0 ? IO_Ok : IO_Error;
+}
+
+
+// `MSG_NOSIGNAL` avoids `SIGPIPE` if the peer has crashed.
+bool
+sendAll(int fd,
+        char const* data,
+        size_t size)
+{
+  while (size > 0)
+  {
+    auto sent = send(fd, data, size, MSG_NOSIGNAL);
+    if (sent < 0 && errno == EINTR)
+      continue;
+    if (sent <= 0)
+      return false;
+    data += sent;
+    size -= static_cast<size_t>(sent);
+  }
+  return true;
+}
+
+
+IOResult
+receiveAll(int fd,
+           char* data,
+           size_t size,
+           int timeoutMs)
+{
+  while (size > 0)
+  {
+    auto ready = waitReadable(fd, timeoutMs);
+    if (ready != IO_Ok)
+      return ready;
+
+    auto got = recv(fd, data, size, 0);
+    if (got < 0 && errno == EINTR)
+      continue;
+    if (got <= 0)
+      return IO_Error;
+    data += got;
+    size -= static_cast<size_t>(got);
+  }
+  return IO_Ok;
+}
+
+
+// A message is a 32-bit length followed by the payload.  `passFd` (if not
+// negative) is attached to the first byte.
+bool
+sendMessage(int fd,
+            QByteArray const& payload,
+            int passFd)
+{
+  quint32 length = static_cast<quint32>(payload.size());
+  QByteArray buffer(reinterpret_cast<char const*>(&length), sizeof length);
+  buffer.append(payload);
+
+  iovec iov = { buffer.data(), static_cast<size_t>(buffer.size()) };
+  msghdr msg = {};
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+
+  union
+  {
+    cmsghdr align;
+    char buffer[CMSG_SPACE(sizeof(int))];
+  } control;
+  if (passFd >= 0)
+  {
+    msg.msg_control = control.buffer;
+    msg.msg_controllen = sizeof control.buffer;
+    auto cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    std::memcpy(CMSG_DATA(cmsg), &passFd, sizeof(int));
+  }
+
+  ssize_t sent;
+  do
+    sent = sendmsg(fd, &msg, MSG_NOSIGNAL);
+  while (sent < 0 && errno == EINTR);
+  if (sent <= 0)
+    return false;
+
+  return sendAll(fd, buffer.constData() + sent,
+                 static_cast<size_t>(buffer.size() - sent));
+}
+
+
+// A passed descriptor is stored in `passedFd` (or closed if it is NULL);
+// it is set to -1 if there is none.
+IOResult
+receiveMessage(int fd,
+               QByteArray& payload,
+               int* passedFd,
+               int timeoutMs)
+{
+  if (passedFd)
+    *passedFd = -1;
+
+  auto ready = waitReadable(fd, timeoutMs);
+  if (ready != IO_Ok)
+    return ready;
+
+  quint32 length = 0;
+  iovec iov = { &length, sizeof length };
+  msghdr msg = {};
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+
+  union
+  {
+    cmsghdr align;
+    char buffer[CMSG_SPACE(sizeof(int))];
+  } control;
+  msg.msg_control = control.buffer;
+  msg.msg_controllen = sizeof control.buffer;
+
+  ssize_t got;
+  do
+    got = recvmsg(fd, &msg, MSG_CMSG_CLOEXEC);
+  while (got < 0 && errno == EINTR);
+  if (got <= 0)
+    return IO_Error;
+
+  int received = -1;
+  for (auto cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg))
+    if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS)
+      std::memcpy(&received, CMSG_DATA(cmsg), sizeof(int));
+
+  auto result = IO_Ok;
+  if (static_cast<size_t>(got) < sizeof length)
+    result = receiveAll(fd, reinterpret_cast<char*>(&length) + got,
+                        sizeof length - static_cast<size_t>(got),
+                        timeoutMs);
+  if (result == IO_Ok && length > MaxMessageSize)
+    result = IO_Error;
+  if (result == IO_Ok)
+  {
+    payload.resize(static_cast<int>(length));
+    result = receiveAll(fd, payload.data(), length, timeoutMs);
+  }
+
+  if (result != IO_Ok || !passedFd)
+  {
+    if (received >= 0)
+      close(received);
+  }
+  else
+    *passedFd = received;
+
+  return result;
+}
+
+
+QByteArray
+writeRequest(FontWallEntry const& entry,
+             FontWallParameters const& params)
+{
+  QByteArray request;
+  QDataStream stream(&request, QIODevice::WriteOnly);
+  stream << entry.filePath
+         << static_cast<qint64>(entry.faceIndex)
+         << static_cast<qint32>(entry.namedInstanceIndex)
+         << params.text
+         << static_cast<qint32>(params.pixelSize)
+         << static_cast<qint32>(params.maxWidth)
+         << static_cast<qint32>(params.loadFlags);
+  return request;
+}
+
+
+void
+readRequest(QByteArray const& request,
+            FontWallEntry& entry,
+            FontWallParameters& params)
+{
+  QDataStream stream(request);
+  qint64 faceIndex;
+  qint32 namedInstanceIndex, pixelSize, maxWidth, loadFlags;
+  stream >> entry.filePath
+         >> faceIndex
+         >> namedInstanceIndex
+         >> params.text
+         >> pixelSize
+         >> maxWidth
+         >> loadFlags;
+
+  entry.faceIndex = static_cast<long>(faceIndex);
+  entry.namedInstanceIndex = namedInstanceIndex;
+  params.pixelSize = pixelSize;
+  params.maxWidth = maxWidth;
+  params.loadFlags = loadFlags;
+}
+
+
+// A row image handed out as a mapping of the worker's shared memory.
+struct MappedImage
+{
+  void* address;
+  size_t size;
+};
+
+
+void
+unmapImage(void* info)
+{
+  auto mapped = static_cast<MappedImage*>(info);
+  munmap(mapped->address, mapped->size);
+  delete mapped;
+}
+
+
+// Copy the image into a new shared memory object; -1 on error.
+int
+createImageMemory(QImage const& image)
+{
+  auto size = static_cast<size_t>(image.sizeInBytes());
+  auto fd = memfd_create("ftinspect-row", MFD_CLOEXEC);
+  if (fd < 0)
+    return -1;
+
+  void* address = MAP_FAILED;
+  if (!ftruncate(fd, static_cast<off_t>(size)))
+    address = mmap(NULL, size, PROT_WRITE, MAP_SHARED, fd, 0);
+  if (address == MAP_FAILED)
+  {
+    close(fd);
+    return -1;
+  }
+
+  std::memcpy(address, image.constBits(), size);
+  munmap(address, size);
+  return fd;
+}
+
+
+QImage
+mapImage(int fd,
+         int width,
+         int height,
+         int bytesPerLine)
+{
+  if (width <= 0 || height <= 0 || bytesPerLine < width)
+    return {};
+
+  // Don't trust the header blindly; mapping beyond the end of the object
+  // would raise `SIGBUS` on access.
+  auto size = static_cast<size_t>(bytesPerLine)
+              * static_cast<size_t>(height);
+  struct stat info;
+  if (fstat(fd, &info) || static_cast<size_t>(info.st_size) < size)
+    return {};
+
+  auto address = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+  if (address == MAP_FAILED)
+    return {};
+
+  return QImage(static_cast<uchar const*>(address),
+                width, height, bytesPerLine,
+                QImage::Format_Grayscale8,
+                unmapImage, new MappedImage{ address, size });
+}
+
+
+QString
+entryLabel(FontWallEntry const& entry)
+{
+  return QString("%1 [%2/%3]")
+           .arg(QFileInfo(entry.filePath).fileName())
+           .arg(entry.faceIndex)
+           .arg(entry.namedInstanceIndex);
+}
+
+} // namespace
+
+#endif // Q_OS_LINUX
+
+
+RenderWorkerPool::RenderWorkerPool()
+{
+}
+
+
+RenderWorkerPool::~RenderWorkerPool()
+{
+  // Idle workers exit as soon as their socket is closed.
+  for (auto& worker : idleWorkers_)
+    stopWorker(worker, false);
+}
+
+
+bool
+RenderWorkerPool::available()
+{
+#ifdef Q_OS_LINUX
+  return true;
+#else
+  return false;
+#endif
+}
+
+
+FontWallResult
+RenderWorkerPool::render(FontWallEntry const& entry,
+                         FontWallParameters const& params)
+{
+#ifdef Q_OS_LINUX
+  FontWallResult result;
+
+  Worker worker;
+  {
+    QMutexLocker locker(&mutex_);
+    if (!idleWorkers_.empty())
+    {
+      worker = idleWorkers_.back();
+      idleWorkers_.pop_back();
+    }
+  }
+  if (worker.pid < 0 && !startWorker(worker))
+  {
+    result.name = QString("%1 (can't start render worker)")
+                    .arg(entryLabel(entry));
+    return result;
+  }
+
+  QByteArray reply;
+  int memoryFd = -1;
+  auto io = IO_Error;
+  if (sendMessage(worker.fd, writeRequest(entry, params), -1))
+    io = receiveMessage(worker.fd, reply, &memoryFd, ReplyTimeoutMs);
+  if (io != IO_Ok)
+  {
+    stopWorker(worker, io == IO_Timeout);
+
+    result.name = QString(io == IO_Timeout
+                            ? "%1 (render worker hung, killed)"
+                            : "%1 (render worker crashed)")
+                    .arg(entryLabel(entry));
+    return result;
+  }
+
+  QDataStream stream(reply);
+  bool hasImage;
+  qint32 width, height, bytesPerLine;
+  stream >> result.name >> hasImage >> width >> height >> bytesPerLine;
+  if (hasImage && memoryFd >= 0)
+    result.image = mapImage(memoryFd, width, height, bytesPerLine);
+  if (memoryFd >= 0)
+    close(memoryFd); // The mapping stays valid.
+
+  QMutexLocker locker(&mutex_);
+  idleWorkers_.push_back(worker);
+  return result;
+#else
+  return FontWallRenderer::render(entry, params);
+#endif
+}
+
+
+int
+RenderWorkerPool::runWorker()
+{
+#ifdef Q_OS_LINUX
+  // Serve requests until the GUI closes the socket.
+  QByteArray request;
+  while (receiveMessage(WorkerFd, request, NULL, -1) == IO_Ok)
+  {
+    FontWallEntry entry;
+    FontWallParameters params;
+    readRequest(request, entry, params);
+
+    auto result = FontWallRenderer::render(entry, params);
+    auto& image = result.image;
+    auto memoryFd = image.isNull() ? -1 : createImageMemory(image);
+
+    QByteArray reply;
+    QDataStream stream(&reply, QIODevice::WriteOnly);
+    stream << result.name
+           << (memoryFd >= 0)
+           << static_cast<qint32>(image.width())
+           << static_cast<qint32>(image.height())
+           << static_cast<qint32>(image.bytesPerLine());
+
+    auto sent = sendMessage(WorkerFd, reply, memoryFd);
+    if (memoryFd >= 0)
+      close(memoryFd);
+    if (!sent)
+      break;
+  }
+  return 0;
+#else
+  return 1;
+#endif
+}
+
+
+bool
+RenderWorkerPool::startWorker(Worker& worker)
+{
+#ifdef Q_OS_LINUX
+  int fds[2];
+  if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds))
+    return false;
+
+  // Prepared before forking; the child may only call async-signal-safe
+  // functions since other threads might hold locks.
+  char path[] = "/proc/self/exe";
+  char* argv[] = { path, const_cast<char*>(WorkerArgument), NULL };
+
+  auto pid = fork();
+  if (pid == 0)
+  {
+    if (fds[1] == WorkerFd)
+      fcntl(WorkerFd, F_SETFD, 0); // Clear `FD_CLOEXEC`.
+    else
+      dup2(fds[1], WorkerFd);
+    execv(path, argv);
+    _exit(127);
+  }
+
+  close(fds[1]);
+  if (pid < 0)
+  {
+    close(fds[0]);
+    return false;
+  }
+
+  worker.pid = pid;
+  worker.fd = fds[0];
+  return true;
+#else
+  Q_UNUSED(worker)
+  return false;
+#endif
+}
+
+
+void
+RenderWorkerPool::stopWorker(Worker& worker,
+                             bool kill)
+{
+#ifdef Q_OS_LINUX
+  close(worker.fd);
+  if (kill)
+    ::kill(worker.pid, SIGKILL);
+
+  int status;
+  while (waitpid(worker.pid, &status, 0) < 0 && errno == EINTR)
+    ;
+#else
+  Q_UNUSED(kill)
+#endif
+
+  worker = Worker();
+}
+
+
+// end of renderworker.cpp
@@ -0,0 +1,63 @@
+// renderworker.hpp
+
+// Copyright (C) 2022-2023 by
+// Charlie Jiang.
+
+#pragma once
+
+#include "fontwall.hpp"
+
+#include <vector>
+
+#include <QMutex>
+#include <QString>
+
+
+// A pool of worker processes that render font wall rows, so that a font
+// crashing (or hanging) a FreeType driver only takes down its worker and
+// not the whole session.  Workers are `ftinspect` itself, started with
+// `WorkerArgument`; they get requests over a UNIX domain socket and return
+// the row images in a `memfd` shared memory object, which the GUI maps
+// without copying.  A crashed worker is reaped and replaced by a new one
+// with the next request.
+//
+// Only available on Linux; elsewhere `render` renders in-process.
+// `render` is thread-safe: each call uses a worker of its own.
+class RenderWorkerPool
+{
+public:
+  RenderWorkerPool();
+  ~RenderWorkerPool();
+
+  static bool available();
+
+  FontWallResult render(FontWallEntry const& entry,
+                        FontWallParameters const& params);
+
+  // Called from `main` if the first argument is `WorkerArgument`.
+  static int runWorker();
+
+  constexpr static const char* WorkerArgument = "--render-worker";
+
+private:
+  // Hung workers are killed after this time.
+  constexpr static int ReplyTimeoutMs = 10000;
+  // The socket is always passed as this descriptor.
+  constexpr static int WorkerFd = 3;
+
+  struct Worker
+  {
+    int pid = -1;
+    int fd = -1;
+  };
+
+  QMutex mutex_;
+  std::vector<Worker> idleWorkers_;
+
+  bool startWorker(Worker& worker);
+  void stopWorker(Worker& worker,
+                  bool kill);
+};
+
+
+// end of renderworker.hpp
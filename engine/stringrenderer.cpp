@@ -6,6 +6,7 @@
 #include "engine.hpp"
 #include "stringrenderer.hpp"
 
+#include <algorithm>
 #include <cmath>
 
 #include <QTextCodec>
@@ -118,6 +119,57 @@ StringRenderer::setUseString(QString const& string)
 }
 
 
+void
+StringRenderer::updateString(QString const& string)
+{
+  if (!usingString_)
+  {
+    setUseString(string);
+    return;
+  }
+
+  auto ucs4 = string.toUcs4();
+
+  // Find the changed range by stripping the common prefix and suffix.
+  auto oldSize = static_cast<int>(activeGlyphs_.size());
+  auto newSize = ucs4.size();
+  int prefix = 0;
+  while (prefix < oldSize && prefix < newSize
+         && activeGlyphs_[prefix].charCodeUcs4
+              == static_cast<int>(ucs4[prefix]))
+    ++prefix;
+  int suffix = 0;
+  while (suffix < oldSize - prefix && suffix < newSize - prefix
+         && activeGlyphs_[oldSize - 1 - suffix].charCodeUcs4
+              == static_cast<int>(ucs4[newSize - 1 - suffix]))
+    ++suffix;
+  if (prefix == oldSize && prefix == newSize)
+    return;
+
+  for (int i = prefix; i < oldSize - suffix; i++)
+    releaseGlyph(activeGlyphs_[i]);
+  activeGlyphs_.erase(activeGlyphs_.begin() + prefix,
+                      activeGlyphs_.begin() + (oldSize - suffix));
+
+  auto insertedCount = newSize - prefix - suffix;
+  activeGlyphs_.insert(activeGlyphs_.begin() + prefix,
+                       static_cast<size_t>(insertedCount),
+                       GlyphContext());
+  for (int i = prefix; i < prefix + insertedCount; i++)
+  {
+    auto& ctx = activeGlyphs_[i];
+    ctx.charCodeUcs4 = ctx.charCode = static_cast<int>(ucs4[i]);
+  }
+  reloadGlyphIndices(prefix, prefix + insertedCount);
+
+  // The advance of the character before the change has the kerning with
+  // its old neighbour applied; reload it, too.
+  if (prefix > 0)
+    releaseGlyph(activeGlyphs_[prefix - 1]);
+  glyphsPending_ = true;
+}
+
+
 void
 StringRenderer::setUseAllGlyphs()
 {
@@ -128,7 +180,8 @@ StringRenderer::setUseAllGlyphs()
 
 
 void
-StringRenderer::reloadGlyphIndices()
+StringRenderer::reloadGlyphIndices(int begin,
+                                   int end)
 {
   if (!usingString_)
     return;
@@ -146,12 +199,25 @@ StringRenderer::reloadGlyphIndices()
 
   if (charMapIndex < 0)
     return;
-  for (auto& ctx : activeGlyphs_)
+  auto useFallback = fontFallback_ && encoding == FT_ENCODING_UNICODE;
+  auto& fallback = engine_->fontFallback();
+  auto currentFontIndex = engine_->currentFontIndex();
+
+  if (end < 0 || end > static_cast<int>(activeGlyphs_.size()))
+    end = static_cast<int>(activeGlyphs_.size());
+  for (int i = std::max(begin, 0); i < end; i++)
   {
+    auto& ctx = activeGlyphs_[i];
     if (encoding != FT_ENCODING_UNICODE)
       ctx.charCode = convertCharEncoding(ctx.charCodeUcs4, encoding);
 
     auto index = engine_->glyphIndexFromCharCode(ctx.charCode, charMapIndex);
+    ctx.fallbackFontIndex = -1;
+    if (!index && useFallback && ctx.charCode >= 0x20)
+      ctx.fallbackFontIndex = fallback.findFont(
+                                static_cast<unsigned long>(ctx.charCode),
+                                currentFontIndex,
+                                &index);
     ctx.glyphIndex = static_cast<int>(index);
   }
 }
@@ -186,13 +252,15 @@ StringRenderer::loadSingleContext(GlyphContext* ctx,
   // TODO use FTC?
 
   // After `prepareRendering`, current size/face is properly set.
-  FT_GlyphSlot slot = engine_->currentFaceSlot();
-  if (engine_->loadGlyphIntoSlotWithoutCache(ctx->glyphIndex) != 0)
-  {
-    ctx->glyph = NULL;
-    return;
-  }
-  if (FT_Get_Glyph(slot, &ctx->glyph) != 0)
+  FT_GlyphSlot slot = NULL;
+  if (ctx->fallbackFontIndex >= 0)
+    slot = engine_->fontFallback().loadGlyph(
+             ctx->fallbackFontIndex,
+             static_cast<unsigned>(ctx->glyphIndex));
+  else if (engine_->loadGlyphIntoSlotWithoutCache(ctx->glyphIndex) == 0)
+    slot = engine_->currentFaceSlot();
+
+  if (!slot || FT_Get_Glyph(slot, &ctx->glyph) != 0)
   {
     ctx->glyph = NULL;
     return;
@@ -218,9 +286,21 @@ StringRenderer::loadSingleContext(GlyphContext* ctx,
 
   if (lsbRsbDeltaEnabled_ && engine_->lcdUsingSubPixelPositioning())
     ctx->hadvance.x += ctx->lsbDelta - ctx->rsbDelta;
+
+  adjustPairAdvance(ctx, prev);
+}
+
+
+void
+StringRenderer::adjustPairAdvance(GlyphContext* ctx,
+                                  GlyphContext* prev)
+{
   prev->hadvance.x += trackingKerning_;
 
-  if (kerningMode_ != KM_None)
+  // Kerning and hinting deltas only apply within runs of glyphs from the
+  // same font; kerning is available for the current font only.
+  auto sameFont = prev->fallbackFontIndex == ctx->fallbackFontIndex;
+  if (kerningMode_ != KM_None && sameFont && ctx->fallbackFontIndex < 0)
   {
     FT_Vector kern = engine_->currentFontKerning(ctx->glyphIndex,
                                                  prev->glyphIndex);
@@ -230,7 +310,8 @@ StringRenderer::loadSingleContext(GlyphContext* ctx,
   }
 
   if (!engine_->lcdUsingSubPixelPositioning()
-      && lsbRsbDeltaEnabled_)
+      && lsbRsbDeltaEnabled_
+      && sameFont)
   {
     if (prev->rsbDelta - ctx->lsbDelta > 32)
       prev->hadvance.x -= 64;
@@ -254,13 +335,26 @@ StringRenderer::loadStringGlyphs()
   GlyphContext* prev = &tempGlyphContext_; // = empty
   tempGlyphContext_ = {};
 
+  // After `updateString`, the unchanged contexts still hold their glyphs
+  // and advances, already adjusted for their successors.  Only fresh
+  // advances of reloaded contexts need adjustment.
+  auto prevReloaded = true;
   for (auto& ctx : activeGlyphs_)
   {
-    loadSingleContext(&ctx, prev);
+    auto reload = !ctx.glyph;
+    if (reload)
+    {
+      GlyphContext unused;
+      loadSingleContext(&ctx, prevReloaded ? prev : &unused);
+    }
+    else if (prevReloaded)
+      adjustPairAdvance(&ctx, prev);
     prev = &ctx;
+    prevReloaded = reload;
   }
 
   glyphCacheValid_ = true;
+  glyphsPending_ = false;
 }
 
 
@@ -320,6 +414,8 @@ StringRenderer::prepareLine(int offset,
       clearActive(true);
       loadStringGlyphs();
     }
+    else if (glyphsPending_)
+      loadStringGlyphs();
 
     for (unsigned n = offset; n < activeGlyphs_.size();)
     {
@@ -546,6 +642,14 @@ StringRenderer::renderLine(int x,
 
   int lineLength = 64 * (vertical_ ? height : width);
 
+  // Untransformed glyphs at small sizes can be taken from the small bitmap
+  // cache, saving the creation and rendering of a copied `FT_Glyph` object.
+  auto useSBitCache = useSBitCache_
+                      && !matrixEnabled_
+                      && !vertical_
+                      && engine_->currentFontMetrics().y_ppem
+                           <= SBitCacheMaxPPEM;
+
   // First prepare the line & determine the line length.
   int totalCount = prepareLine(offset, lineLength, pen,
                                nonSpacingPlaceholder, handleMultiLine);
@@ -584,16 +688,46 @@ StringRenderer::renderLine(int x,
 
     advance = vertical_ ? ctx.vadvance : ctx.hadvance;
 
-    QRect rect;
-    QImage* colorLayerImage
-      = engine_->renderingEngine()->tryDirectRenderColorLayers(ctx.glyphIndex,
-                                                               &rect,
-                                                               true);
+    // A glyph the receiver still holds an image of isn't rendered again,
+    // neither directly nor from a copy.
+    auto cached = cachedGlyphCallback_
+                  && cachedGlyphCallback_({ (pen.x >> 6),
+                                            height - (pen.y >> 6) },
+                                          ctx);
 
-    if (colorLayerImage)
+    // Direct rendering uses the current font.
+    QRect rect;
+    QImage* colorLayerImage = NULL;
+    if (!cached && ctx.fallbackFontIndex < 0)
+      colorLayerImage = engine_->renderingEngine()->tryDirectRenderColorLayers(
+                          ctx.glyphIndex, &rect, true);
+
+    QImage* sbitImage = NULL;
+    if (!cached && !colorLayerImage
+        && useSBitCache && ctx.fallbackFontIndex < 0)
+      sbitImage = engine_->renderingEngine()->tryDirectRenderSBit(
+                    ctx.glyphIndex, &rect, true);
+
+    if (cached)
+    {
+      if (matrixEnabled_) // Same as below.
+        FT_Vector_Transform(&advance, &matrix_);
+    }
+    else if (colorLayerImage)
     {
       FT_Vector penPos = { (pen.x >> 6), height - (pen.y >> 6) };
       renderImageCallback_(colorLayerImage, rect, penPos, advance, ctx);
+
+      // The pen must advance the same way for pooled images.
+      if (matrixEnabled_)
+        FT_Vector_Transform(&advance, &matrix_);
+    }
+    else if (sbitImage)
+    {
+      // Pass the advance in 16.16 format as `renderCallback_` does via the
+      // glyph object.
+      FT_Vector penPos = { (pen.x >> 6), height - (pen.y >> 6) };
+      renderImageCallback_(sbitImage, rect, penPos, ctx.glyph->advance, ctx);
     }
     else
     {
@@ -659,18 +793,24 @@ void
 StringRenderer::clearActive(bool glyphOnly)
 {
   for (auto& ctx : activeGlyphs_)
-  {
-    if (ctx.cacheNode)
-      FTC_Node_Unref(ctx.cacheNode, engine_->cacheManager());
-    else if (ctx.glyph)
-      FT_Done_Glyph(ctx.glyph); // When caching isn't used.
-    ctx.cacheNode = NULL;
-    ctx.glyph = NULL;
-  }
+    releaseGlyph(ctx);
   if (!glyphOnly)
     activeGlyphs_.clear();
 
   glyphCacheValid_ = false;
+  glyphsPending_ = false;
+}
+
+
+void
+StringRenderer::releaseGlyph(GlyphContext& ctx)
+{
+  if (ctx.cacheNode)
+    FTC_Node_Unref(ctx.cacheNode, engine_->cacheManager());
+  else if (ctx.glyph)
+    FT_Done_Glyph(ctx.glyph); // When caching isn't used.
+  ctx.cacheNode = NULL;
+  ctx.glyph = NULL;
 }
 
 
@@ -25,6 +25,9 @@ struct GlyphContext
   int charCode = 0;
   int charCodeUcs4 = 0;
   int glyphIndex = 0;
+  // If not negative, the glyph is taken from this opened font instead of
+  // the current one (see `FontFallback`), and `glyphIndex` refers to it.
+  int fallbackFontIndex = -1;
   FT_Glyph glyph = NULL;
   FTC_Node cacheNode = NULL;
 
@@ -102,6 +105,14 @@ public:
   //   }
   using PreprocessCallback = std::function<void(FT_Glyph*)>;
 
+  // Called before a glyph is rendered, either directly (color layers, small
+  // bitmaps) for the image callback or from a copy that is preprocessed and
+  // passed to the render callback.  If the receiver still holds an image of
+  // the glyph rendered with the current settings, it can output that one
+  // and return `true`; all the work for the glyph is skipped then.
+  using CachedGlyphCallback = std::function<bool(FT_Vector, // penPos
+                                                 GlyphContext&)>;
+
   // Called when a new line begins.
   using LineBeginCallback = std::function<void(FT_Vector, // initial penPos
                                                double)>; // size (points)
@@ -118,6 +129,8 @@ public:
          { renderImageCallback_ = std::move(cb); }
   void setPreprocessCallback(PreprocessCallback cb)
          { glyphPreprocessCallback_ = std::move(cb); }
+  void setCachedGlyphCallback(CachedGlyphCallback cb)
+         { cachedGlyphCallback_ = std::move(cb); }
   void setLineBeginCallback(LineBeginCallback cb)
          { lineBeginCallback_ = std::move(cb); }
 
@@ -137,9 +150,18 @@ public:
   void setPosition(double pos) { position_ = pos; }
   void setLsbRsbDelta(bool enabled) { lsbRsbDeltaEnabled_ = enabled; }
   void setKerning(bool kerning);
+  // Take characters missing in the current font from other opened fonts.
+  // Only effective for strings and Unicode charmaps.
+  void setFontFallback(bool fallback) { fontFallback_ = fallback; }
+  // Only enable this if the preprocess callback doesn't modify glyphs.
+  void setUseSBitCache(bool useSBitCache) { useSBitCache_ = useSBitCache; }
 
   // Need to be called when font or charMap changes.
   void setUseString(QString const& string);
+  // Like `setUseString`, but only the changed part of the string gets new
+  // contexts; glyphs already loaded for the unchanged characters are kept.
+  // Only use this if no other parameter changed since the last rendering.
+  void updateString(QString const& string);
   void setUseAllGlyphs();
 
   //////// Actions
@@ -164,7 +186,9 @@ private:
   // 1. If in string mode, the string is load into `activeGlyphs_`
   //    (in `updateString`).
   // 2. The character codes in contexts are converted to glyph indices
-  //    (in `reloadGlyphIndices`).
+  //    (in `reloadGlyphIndices`).  With font fallback, characters missing
+  //    in the current font are assigned to the first opened font covering
+  //    them.
   // 3. If in string mode, glyphs are loaded into contexts
   //    (in `loadStringGlyphs`).
   // 4. In `render` function, according to mode, `renderLine` is called line
@@ -174,7 +198,11 @@ private:
   //    will be reused).  If in string mode, it will directly use the
   //    prepared glyphs.  Preprocessing is done within this step, such as
   //    emboldening or stroking.  Eventually the `FT_Glyph` pointer is
-  //    passed to the callback.
+  //    passed to the callback.  If neither transformation nor preprocessing
+  //    is needed, the pre-rendered bitmap is taken from the small bitmap
+  //    cache instead and passed to the image callback.  Glyphs for which
+  //    the receiver already holds an image are skipped (see
+  //    `CachedGlyphCallback`).
 
   GlyphContext tempGlyphContext_;
 
@@ -193,6 +221,8 @@ private:
   // will trigger different levels of flushing.
   std::vector<GlyphContext> activeGlyphs_;
   bool glyphCacheValid_ = false;
+  // Set by `updateString` if some contexts need (re)loading.
+  bool glyphsPending_ = false;
 
   int charMapIndex_ = 0;
   int limitIndex_ = 0;
@@ -207,21 +237,35 @@ private:
   FT_Matrix matrix_ = {};
   bool matrixEnabled_ = false;
   bool lsbRsbDeltaEnabled_ = true;
+  bool useSBitCache_ = false;
+  bool fontFallback_ = false;
 
   bool waterfall_ = false;
   double waterfallStart_ = -1;
   double waterfallEnd_ = -1; // -1 = Auto
 
+  // Glyph bitmaps in the small bitmap cache are limited to 255 pixels; if
+  // the ppem value is larger, most lookups would fail.
+  constexpr static int SBitCacheMaxPPEM = 128;
+
   RenderCallback renderCallback_;
   RenderImageCallback renderImageCallback_;
   PreprocessCallback glyphPreprocessCallback_;
+  CachedGlyphCallback cachedGlyphCallback_;
   LineBeginCallback lineBeginCallback_;
 
-  void reloadGlyphIndices(); // For string rendering.
+  // For string rendering; `end` < 0 means the end of the string.
+  void reloadGlyphIndices(int begin = 0,
+                          int end = -1);
   void prepareRendering();
   void loadSingleContext(GlyphContext* ctx,
                          GlyphContext* prev);
-  // Need to be called when font, charMap or size changes.
+  // Apply kerning, tracking, and hinting deltas between `prev` and `ctx` to
+  // the advance of `prev`.
+  void adjustPairAdvance(GlyphContext* ctx,
+                         GlyphContext* prev);
+  // Need to be called when font, charMap or size changes.  Only contexts
+  // without a glyph are loaded.
   void loadStringGlyphs();
   // Returns total line count.
   int prepareLine(int offset,
@@ -230,6 +274,7 @@ private:
                   int nonSpacingPlaceholder,
                   bool handleMultiLine = false);
   void clearActive(bool glyphOnly = false);
+  void releaseGlyph(GlyphContext& ctx);
 
   int convertCharEncoding(int charUcs4,
                           FT_Encoding encoding);
@@ -771,7 +771,9 @@ FT_BEGIN_HEADER
    * number of bytecode instructions executed for a single run of the
    * bytecode interpreter, needed to prevent infinite loops.  You don't want
    * to change this except for very special situations (e.g., making a
-   * library fuzzer spend less time to handle broken fonts).
+   * library fuzzer spend less time to handle broken fonts).  At runtime,
+   * the limit can be changed with the 'max-runnable-opcodes' property of
+   * the 'truetype' driver; this is its default value.
    *
    * It is not expected that this value is ever modified by a configuring
    * script; instead, it gets surrounded with `#ifndef ... #endif` so that
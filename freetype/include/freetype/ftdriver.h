@@ -820,6 +820,231 @@ FT_BEGIN_HEADER
    *   2.5
    */
 
+  /**************************************************************************
+   *
+   * @property:
+   *   component-cache
+   *
+   * @description:
+   *   If set to TRUE, the 'truetype' driver caches simple glyphs that get
+   *   loaded as components of composite glyphs, in their scaled and hinted
+   *   form.  The cache is attached to the size object; it is flushed if the
+   *   size, the load flags, the interpreter version, or the variation
+   *   coordinates change.
+   *
+   *   Fonts that build many glyphs from a small set of components (for
+   *   example, accented Latin letters or CJK fonts constructed from
+   *   radicals) load considerably faster if all glyphs of a size are
+   *   loaded in sequence.  The default is FALSE.
+   *
+   *   Cached components are not re-hinted.  A font whose glyph programs
+   *   depend on state modified by other glyphs (for example, the storage
+   *   area) may thus be rendered slightly differently.  The cache is not
+   *   used with the 'Infinality' interpreter (version~38) or the
+   *   incremental interface.
+   *
+   * @note:
+   *   This property can be used with @FT_Property_Get also.
+   *
+   *   This property can be set via the `FREETYPE_PROPERTIES` environment
+   *   variable (using values 1 and 0 for 'on' and 'off', respectively).
+   *
+   * @example:
+   *   ```
+   *     FT_Library  library;
+   *     FT_Bool     component_cache = TRUE;
+   *
+   *
+   *     FT_Init_FreeType( &library );
+   *
+   *     FT_Property_Set( library, "truetype",
+   *                               "component-cache", &component_cache );
+   *   ```
+   *
+   * @since:
+   *   2.13.1
+   *
+   */
+
+
+  /**************************************************************************
+   *
+   * @property:
+   *   prep-cache
+   *
+   * @description:
+   *   If set to TRUE, the 'truetype' driver keeps a snapshot of the
+   *   bytecode interpreter's state after running the CVT program ('prep'
+   *   table): the scaled CVT, the storage area, the twilight zone, the
+   *   graphics state, and function and instruction definitions.  The
+   *   snapshots are attached to the face object and keyed by everything
+   *   the CVT program can observe (the scaling, the interpreter version
+   *   and its rendering mode flags, and the variation coordinates).  A
+   *   size object that needs the CVT program's result with a known key
+   *   restores the snapshot instead of executing the program again.
+   *
+   *   This matters for fonts with heavy 'prep' tables if size objects get
+   *   created and destroyed frequently, as a cache manager does.  At most
+   *   32~snapshots are kept per face; if more are needed, the oldest one
+   *   gets replaced.  The default is FALSE.
+   *
+   *   The cache is not used with the 'Infinality' interpreter (version~38)
+   *   or if a debug hook replaces the bytecode interpreter.
+   *
+   * @note:
+   *   This property can be used with @FT_Property_Get also.
+   *
+   *   This property can be set via the `FREETYPE_PROPERTIES` environment
+   *   variable (using values 1 and 0 for 'on' and 'off', respectively).
+   *
+   * @example:
+   *   ```
+   *     FT_Library  library;
+   *     FT_Bool     prep_cache = TRUE;
+   *
+   *
+   *     FT_Init_FreeType( &library );
+   *
+   *     FT_Property_Set( library, "truetype",
+   *                               "prep-cache", &prep_cache );
+   *   ```
+   *
+   * @since:
+   *   2.13.1
+   *
+   */
+
+
+  /**************************************************************************
+   *
+   * @property:
+   *   max-runnable-opcodes
+   *
+   * @description:
+   *   The maximum number of bytecode instructions the 'truetype' driver
+   *   executes in a single run of the interpreter (that is, for the font
+   *   program, the CVT program, or the instructions of a single glyph or
+   *   composite component).  A program exceeding it is aborted with error
+   *   `Execution_Too_Long`.  The value must be positive; the default is
+   *   `TT_CONFIG_OPTION_MAX_RUNNABLE_OPCODES` (one million unless changed
+   *   at compile time).
+   *
+   *   Applications that display untrusted fonts interactively can lower
+   *   this limit so that malformed or hostile bytecode can't block them
+   *   for seconds per glyph.  Note that, unless @FT_LOAD_PEDANTIC is set,
+   *   an aborted glyph program doesn't make @FT_Load_Glyph fail; the glyph
+   *   is returned with the hinting done so far.  Use @aborted-runs to
+   *   detect this.
+   *
+   * @note:
+   *   This property can be used with @FT_Property_Get also.
+   *
+   *   This property can be set via the `FREETYPE_PROPERTIES` environment
+   *   variable.
+   *
+   * @example:
+   *   ```
+   *     FT_Library  library;
+   *     FT_ULong    max_runnable_opcodes = 100000;
+   *
+   *
+   *     FT_Init_FreeType( &library );
+   *
+   *     FT_Property_Set( library, "truetype",
+   *                               "max-runnable-opcodes",
+   *                               &max_runnable_opcodes );
+   *   ```
+   *
+   * @since:
+   *   2.13.1
+   *
+   */
+
+
+  /**************************************************************************
+   *
+   * @property:
+   *   aborted-runs
+   *
+   * @description:
+   *   The number of bytecode interpreter runs of the 'truetype' driver that
+   *   have been aborted because they exceeded the limit set with
+   *   @max-runnable-opcodes.  Reading the counter before and after loading
+   *   a glyph tells whether its hinting was cut short, even if
+   *   @FT_Load_Glyph succeeded.  Setting the property assigns a new value
+   *   to the counter, e.g., zero.
+   *
+   * @note:
+   *   This property can be used with @FT_Property_Get also.
+   *
+   *   The counter is shared by all faces handled by the driver.
+   *
+   * @example:
+   *   ```
+   *     FT_ULong  before, after;
+   *
+   *
+   *     FT_Property_Get( library, "truetype", "aborted-runs", &before );
+   *     FT_Load_Glyph( face, glyph_index, FT_LOAD_DEFAULT );
+   *     FT_Property_Get( library, "truetype", "aborted-runs", &after );
+   *
+   *     if ( after != before )
+   *       ... the glyph program was too long ...
+   *   ```
+   *
+   * @since:
+   *   2.13.1
+   *
+   */
+
+
+  /**************************************************************************
+   *
+   * @property:
+   *   charstring-cache
+   *
+   * @description:
+   *   If set to TRUE, the 't1cid' driver keeps the glyph charstrings of a
+   *   CID-keyed face in memory after they have been loaded the first time,
+   *   already decrypted.  Otherwise, a glyph's charstring is read from the
+   *   font file and decrypted each time the glyph gets loaded.  The default
+   *   is FALSE.
+   *
+   *   The cache is attached to the face object and grows with the number
+   *   of distinct glyphs loaded; it is released together with the face.
+   *   Entries cached while the property was set are still used after it
+   *   has been reset.
+   *
+   *   The 'type1' driver doesn't need this property: it decrypts all
+   *   charstrings and subroutines while loading the face.  The same holds
+   *   for the subroutines of CID-keyed fonts.
+   *
+   * @note:
+   *   This property can be used with @FT_Property_Get also.
+   *
+   *   This property can be set via the `FREETYPE_PROPERTIES` environment
+   *   variable (using values 1 and 0 for 'on' and 'off', respectively).
+   *
+   *   The cache is not used with the incremental interface.
+   *
+   * @example:
+   *   ```
+   *     FT_Library  library;
+   *     FT_Bool     charstring_cache = TRUE;
+   *
+   *
+   *     FT_Init_FreeType( &library );
+   *
+   *     FT_Property_Set( library, "t1cid",
+   *                               "charstring-cache", &charstring_cache );
+   *   ```
+   *
+   * @since:
+   *   2.13.1
+   *
+   */
+
+
   /**************************************************************************
    *
    * @property:
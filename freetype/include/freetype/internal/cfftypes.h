@@ -24,6 +24,7 @@
 #include <freetype/freetype.h>
 #include <freetype/t1tables.h>
 #include <freetype/internal/ftserv.h>
+#include <freetype/internal/fthash.h>
 #include <freetype/internal/services/svpscmap.h>
 #include <freetype/internal/pshints.h>
 #include <freetype/internal/t1types.h>
@@ -405,6 +406,9 @@ FT_BEGIN_HEADER
     /* since version 2.9 */
     PS_FontExtraRec*  font_extra;
 
+    /* since version 2.13.1 */
+    FT_Hash  glyph_names_hash;   /* glyph name -> index, built lazily */
+
   } CFF_FontRec;
 
 
@@ -46,6 +46,7 @@ FT_BEGIN_HEADER
     FT_Bool   no_stem_darkening;
     FT_Int    darken_params[8];
     FT_Int32  random_seed;
+    FT_Bool   charstring_cache;  /* only used by the `t1cid' driver */
 
   } PS_DriverRec, *PS_Driver;
 
@@ -114,6 +114,7 @@ FT_BEGIN_HEADER
 
     FT_Int           num_glyphs;
     FT_String**      glyph_names;       /* array of glyph names       */
+    FT_Hash          glyph_names_hash;  /* name -> index, built lazily */
     FT_Byte**        charstrings;       /* array of glyph charstrings */
     FT_UInt*         charstrings_len;
 
@@ -199,6 +200,16 @@ FT_BEGIN_HEADER
   typedef struct CID_FaceRec_*  CID_Face;
 
 
+  /* a glyph charstring of a CID-keyed font, already decrypted */
+  typedef struct  CID_CharstringRec_
+  {
+    FT_Byte*  data;       /* NULL if not loaded yet; includes lenIV bytes */
+    FT_ULong  length;
+    FT_UInt   fd_select;
+
+  } CID_CharstringRec, *CID_Charstring;
+
+
   typedef struct  T1_FaceRec_
   {
     FT_FaceRec      root;
@@ -248,6 +259,10 @@ FT_BEGIN_HEADER
     FT_Byte*         binary_data; /* used if hex data has been converted */
     FT_Stream        cid_stream;
 
+    /* since version 2.13.1 - `cid_count' entries, allocated on first */
+    /* use if the `charstring-cache' property is set                  */
+    CID_Charstring   charstrings;
+
   } CID_FaceRec;
 
 
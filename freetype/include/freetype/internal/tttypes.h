@@ -23,6 +23,7 @@
 
 #include <freetype/tttables.h>
 #include <freetype/internal/ftobjs.h>
+#include <freetype/internal/fthash.h>
 #include <freetype/ftcolor.h>
 
 #ifdef TT_CONFIG_OPTION_GX_VAR_SUPPORT
@@ -849,6 +850,11 @@ FT_BEGIN_HEADER
    *
    *   format_25 ::
    *     The sub-table used for format 2.5.
+   *
+   *   name_index ::
+   *     A hash table mapping glyph names to glyph indices, built on the
+   *     first call to `FT_Get_Name_Index`.  Its keys point into the name
+   *     tables above (or to the standard Macintosh names).
    */
   typedef struct  TT_Post_NamesRec_
   {
@@ -861,6 +867,8 @@ FT_BEGIN_HEADER
 
     } names;
 
+    FT_Hash  name_index;
+
   } TT_Post_NamesRec, *TT_Post_Names;
 
 
@@ -1647,6 +1655,10 @@ FT_BEGIN_HEADER
     /* since 2.12 */
     void*                 svg;
 
+    /* since 2.13.1; snapshots of the state after running `prep', */
+    /* owned by the `truetype' driver                             */
+    void*                 prep_cache;
+
   } TT_FaceRec;
 
 
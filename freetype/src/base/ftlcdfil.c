@@ -31,6 +31,162 @@
 #define FT_SHIFTCLAMP( x )  ( x >>= 8, (FT_Byte)( x > 255 ? 255 : x ) )
 
 
+  /*
+   * The FIR filters below have SSE2 variants that process eight pixels at
+   * once with 16-bit arithmetic.  All products of 8-bit weights and 8-bit
+   * values fit into 16 bits, and all terms are non-negative; summing them
+   * with unsigned saturation thus yields `min(sum, 0xFFFF)`, which gives
+   * exactly the same result as `FT_SHIFTCLAMP` after shifting by 8 bits.
+   *
+   * SSE2 is part of the x86_64 baseline, so, as in `ftgrays.c`, we select
+   * the implementation at compile time.
+   */
+#if defined( __SSE2__ )                          || \
+    defined( __x86_64__ )                        || \
+    defined( _M_AMD64 )                          || \
+    ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#  define FT_LCD_SSE2  1
+#else
+#  define FT_LCD_SSE2  0
+#endif
+
+#if FT_LCD_SSE2
+
+#  include <emmintrin.h>
+
+
+  /* Filter a row of `width' pixels in place; `width' must be at least 2. */
+  static void
+  ft_lcd_filter_fir_row_sse2( FT_Byte*             line,
+                              FT_UInt              width,
+                              FT_LcdFiveTapFilter  weights )
+  {
+    __m128i  zero = _mm_setzero_si128();
+    __m128i  w0   = _mm_set1_epi16( (short)weights[0] );
+    __m128i  w1   = _mm_set1_epi16( (short)weights[1] );
+    __m128i  w2   = _mm_set1_epi16( (short)weights[2] );
+    __m128i  w3   = _mm_set1_epi16( (short)weights[3] );
+    __m128i  w4   = _mm_set1_epi16( (short)weights[4] );
+
+    /* the original values of the two pixels left of `xx', */
+    /* which have already been overwritten                 */
+    FT_UInt  prev2 = 0;
+    FT_UInt  prev1 = 0;
+    FT_UInt  xx;
+
+
+    /* `out[x] = w0 * in[x + 2] + w1 * in[x + 1] + w2 * in[x] +  */
+    /*           w3 * in[x - 1] + w4 * in[x - 2]',                */
+    /* with `in' being zero outside of the row                   */
+    for ( xx = 0; xx + 10 <= width; xx += 8 )
+    {
+      __m128i  c, m1, m2, p1, p2, sum;
+
+
+      c  = _mm_unpacklo_epi8(
+             _mm_loadl_epi64( (const __m128i*)( line + xx ) ), zero );
+      p1 = _mm_unpacklo_epi8(
+             _mm_loadl_epi64( (const __m128i*)( line + xx + 1 ) ), zero );
+      p2 = _mm_unpacklo_epi8(
+             _mm_loadl_epi64( (const __m128i*)( line + xx + 2 ) ), zero );
+      m1 = _mm_or_si128( _mm_slli_si128( c, 2 ),
+                         _mm_cvtsi32_si128( (int)prev1 ) );
+      m2 = _mm_or_si128( _mm_slli_si128( c, 4 ),
+                         _mm_cvtsi32_si128( (int)( prev2 | prev1 << 16 ) ) );
+
+      sum = _mm_mullo_epi16( p2, w0 );
+      sum = _mm_adds_epu16( sum, _mm_mullo_epi16( p1, w1 ) );
+      sum = _mm_adds_epu16( sum, _mm_mullo_epi16( c,  w2 ) );
+      sum = _mm_adds_epu16( sum, _mm_mullo_epi16( m1, w3 ) );
+      sum = _mm_adds_epu16( sum, _mm_mullo_epi16( m2, w4 ) );
+
+      prev2 = line[xx + 6];
+      prev1 = line[xx + 7];
+
+      _mm_storel_epi64( (__m128i*)( line + xx ),
+                        _mm_packus_epi16( _mm_srli_epi16( sum, 8 ), zero ) );
+    }
+
+    /* the remaining pixels */
+    for ( ; xx < width; xx++ )
+    {
+      FT_UInt  val = line[xx];
+      FT_UInt  fir;
+
+
+      fir = weights[2] * val + weights[3] * prev1 + weights[4] * prev2;
+      if ( xx + 1 < width )
+        fir += weights[1] * line[xx + 1];
+      if ( xx + 2 < width )
+        fir += weights[0] * line[xx + 2];
+
+      prev2 = prev1;
+      prev1 = val;
+
+      line[xx] = FT_SHIFTCLAMP( fir );
+    }
+  }
+
+
+  /* Filter eight adjacent columns of `height' pixels in place, */
+  /* walking from `col' in steps of `-pitch'; `height' must be  */
+  /* at least 2.                                                */
+  static void
+  ft_lcd_filter_fir_columns_sse2( FT_Byte*             col,
+                                  FT_UInt              height,
+                                  FT_Int               pitch,
+                                  FT_LcdFiveTapFilter  weights )
+  {
+    __m128i  zero = _mm_setzero_si128();
+    __m128i  w0   = _mm_set1_epi16( (short)weights[0] );
+    __m128i  w1   = _mm_set1_epi16( (short)weights[1] );
+    __m128i  w2   = _mm_set1_epi16( (short)weights[2] );
+    __m128i  w3   = _mm_set1_epi16( (short)weights[3] );
+    __m128i  w4   = _mm_set1_epi16( (short)weights[4] );
+
+    /* sliding window of the original values of rows `yy - 2' */
+    /* to `yy + 1'                                            */
+    __m128i  m2 = zero;
+    __m128i  m1 = zero;
+    __m128i  c, p1;
+    FT_UInt  yy;
+
+
+#define FT_LCD_LOAD_ROW( p )                                       \
+          _mm_unpacklo_epi8(                                       \
+            _mm_loadl_epi64( (const __m128i*)(p) ), zero )
+
+    c  = FT_LCD_LOAD_ROW( col );
+    p1 = FT_LCD_LOAD_ROW( col - pitch );
+
+    for ( yy = 0; yy < height; yy++, col -= pitch )
+    {
+      __m128i  p2, sum;
+
+
+      p2 = yy + 2 < height ? FT_LCD_LOAD_ROW( col - 2 * pitch ) : zero;
+
+      sum = _mm_mullo_epi16( p2, w0 );
+      sum = _mm_adds_epu16( sum, _mm_mullo_epi16( p1, w1 ) );
+      sum = _mm_adds_epu16( sum, _mm_mullo_epi16( c,  w2 ) );
+      sum = _mm_adds_epu16( sum, _mm_mullo_epi16( m1, w3 ) );
+      sum = _mm_adds_epu16( sum, _mm_mullo_epi16( m2, w4 ) );
+
+      _mm_storel_epi64( (__m128i*)col,
+                        _mm_packus_epi16( _mm_srli_epi16( sum, 8 ), zero ) );
+
+      m2 = m1;
+      m1 = c;
+      c  = p1;
+      p1 = p2;
+    }
+
+#undef FT_LCD_LOAD_ROW
+  }
+
+#endif /* FT_LCD_SSE2 */
+
+
   /* add padding according to filter weights */
   FT_BASE_DEF( void )
   ft_lcd_padding( FT_BBox*        cbox,
@@ -95,6 +251,10 @@
       FT_Byte*  line = origin;
 
 
+#if FT_LCD_SSE2
+      for ( ; height > 0; height--, line -= pitch )
+        ft_lcd_filter_fir_row_sse2( line, width, weights );
+#else
       /* `fir' must be at least 32 bit wide, since the sum of */
       /* the values in `weights' can exceed 0xFF              */
 
@@ -130,6 +290,7 @@
         line[xx - 2] = FT_SHIFTCLAMP( fir[1] );
         line[xx - 1] = FT_SHIFTCLAMP( fir[2] );
       }
+#endif
     }
 
     /* vertical in-place FIR filter */
@@ -138,6 +299,11 @@
       FT_Byte*  column = origin;
 
 
+#if FT_LCD_SSE2
+      for ( ; width >= 8; width -= 8, column += 8 )
+        ft_lcd_filter_fir_columns_sse2( column, height, pitch, weights );
+#endif
+
       for ( ; width > 0; width--, column++ )
       {
         FT_Byte*  col = column;
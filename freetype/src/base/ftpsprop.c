@@ -220,6 +220,31 @@
       return error;
     }
 
+    /* only the `t1cid' driver decrypts charstrings while loading glyphs */
+    else if ( !ft_strcmp( property_name, "charstring-cache" ) &&
+              !ft_strcmp( module->clazz->module_name, "t1cid" ) )
+    {
+#ifdef FT_CONFIG_OPTION_ENVIRONMENT_PROPERTIES
+      if ( value_is_string )
+      {
+        const char*  s  = (const char*)value;
+        long         cc = ft_strtol( s, NULL, 10 );
+
+
+        driver->charstring_cache = FT_BOOL( cc );
+      }
+      else
+#endif
+      {
+        FT_Bool*  charstring_cache = (FT_Bool*)value;
+
+
+        driver->charstring_cache = *charstring_cache;
+      }
+
+      return error;
+    }
+
     FT_TRACE2(( "ps_property_set: missing property `%s'\n",
                 property_name ));
     return FT_THROW( Missing_Property );
@@ -275,6 +300,17 @@
       return error;
     }
 
+    else if ( !ft_strcmp( property_name, "charstring-cache" ) &&
+              !ft_strcmp( module->clazz->module_name, "t1cid" ) )
+    {
+      FT_Bool*  val = (FT_Bool*)value;
+
+
+      *val = driver->charstring_cache;
+
+      return error;
+    }
+
     FT_TRACE2(( "ps_property_get: missing property `%s'\n",
                 property_name ));
     return FT_THROW( Missing_Property );
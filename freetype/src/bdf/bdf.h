@@ -157,6 +157,18 @@ FT_BEGIN_HEADER
   } bdf_glyph_t;
 
 
+  /* Glyph bitmaps are carved out of large, zero-initialized blocks   */
+  /* instead of being allocated one by one; the blocks are chained and */
+  /* released together in `bdf_free_font'.                             */
+  typedef struct  bdf_bitmap_block_t_
+  {
+    struct bdf_bitmap_block_t_*  next;
+
+  } bdf_bitmap_block_t;
+
+#define BDF_BITMAP_BLOCK_SIZE  0x8000UL
+
+
   typedef struct  bdf_font_t_
   {
     char*            name;           /* Name of the font.                   */
@@ -200,6 +212,10 @@ FT_BEGIN_HEADER
     unsigned long    nuser_props;
     FT_HashRec       proptbl;
 
+    bdf_bitmap_block_t*  bitmap_blocks;  /* Glyph bitmap storage.          */
+    unsigned char*       bitmap_cursor;  /* Next free byte in first block. */
+    unsigned long        bitmap_avail;   /* Free bytes in first block.     */
+
   } bdf_font_t;
 
 
@@ -1281,6 +1281,46 @@
   }
 
 
+  /* Get `size' bytes of zeroed storage for a glyph bitmap. */
+  static FT_Error
+  bdf_alloc_bitmap_( bdf_font_t*      font,
+                     unsigned long    size,
+                     unsigned char*  *abitmap )
+  {
+    FT_Memory            memory = font->memory;
+    bdf_bitmap_block_t*  block;
+    unsigned long        block_size;
+    FT_Error             error  = FT_Err_Ok;
+
+
+    *abitmap = NULL;
+
+    if ( size == 0 )
+      goto Exit;
+
+    if ( size > font->bitmap_avail )
+    {
+      block_size = FT_MAX( size, BDF_BITMAP_BLOCK_SIZE );
+
+      /* the bitmap data follows the block header */
+      if ( FT_ALLOC( block, sizeof ( *block ) + block_size ) )
+        goto Exit;
+
+      block->next         = font->bitmap_blocks;
+      font->bitmap_blocks = block;
+      font->bitmap_cursor = (unsigned char*)( block + 1 );
+      font->bitmap_avail  = block_size;
+    }
+
+    *abitmap             = font->bitmap_cursor;
+    font->bitmap_cursor += size;
+    font->bitmap_avail  -= size;
+
+  Exit:
+    return error;
+  }
+
+
   /* Actually parse the glyph info and bitmaps. */
   static FT_Error
   bdf_parse_glyphs_( char*          line,
@@ -1311,6 +1351,16 @@
     font   = p->font;
     memory = font->memory;
 
+    /* Bitmap rows are by far the most frequent lines, so don't test    */
+    /* them against all keywords first.  Only `COMMENT', `ENCODING',    */
+    /* `ENDCHAR', and `ENDFONT' start with a hex digit and are handled  */
+    /* before bitmap rows below; everything else takes the same branch. */
+    if ( ( p->flags & BDF_BITMAP_ )  &&
+         sbitset( hdigits, line[0] ) &&
+         line[0] != 'C'              &&
+         line[0] != 'E'              )
+      goto Glyph_Data;
+
     /* Check for a comment. */
     if ( _bdf_strncmp( line, "COMMENT", 7 ) == 0 )
     {
@@ -1549,6 +1599,7 @@
     if ( !( p->flags & BDF_ENCODING_ ) )
       goto Missing_Encoding;
 
+  Glyph_Data:
     /* Point at the glyph being constructed. */
     if ( p->glyph_enc == -1 )
       glyph = font->unencoded + ( font->unencoded_used - 1 );
@@ -1736,7 +1787,8 @@
       else
         glyph->bytes = (unsigned short)bitmap_size;
 
-      if ( FT_ALLOC( glyph->bitmap, glyph->bytes ) )
+      error = bdf_alloc_bitmap_( font, glyph->bytes, &glyph->bitmap );
+      if ( error )
         goto Exit;
 
       p->row    = 0;
@@ -2338,21 +2390,25 @@
     /* Free up the character info. */
     for ( i = 0, glyphs = font->glyphs;
           i < font->glyphs_used; i++, glyphs++ )
-    {
       FT_FREE( glyphs->name );
-      FT_FREE( glyphs->bitmap );
-    }
 
     for ( i = 0, glyphs = font->unencoded; i < font->unencoded_used;
           i++, glyphs++ )
-    {
       FT_FREE( glyphs->name );
-      FT_FREE( glyphs->bitmap );
-    }
 
     FT_FREE( font->glyphs );
     FT_FREE( font->unencoded );
 
+    /* Free up the glyph bitmaps. */
+    while ( font->bitmap_blocks )
+    {
+      bdf_bitmap_block_t*  next = font->bitmap_blocks->next;
+
+
+      FT_FREE( font->bitmap_blocks );
+      font->bitmap_blocks = next;
+    }
+
     /* bdf_cleanup */
     ft_hash_str_free( &(font->proptbl), memory );
 
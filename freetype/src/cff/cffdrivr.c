@@ -379,6 +379,57 @@
   }
 
 
+  /* Build a hash table mapping glyph names to indices; the keys point */
+  /* into the string index or to the standard strings of `psnames'.    */
+  static FT_Error
+  cff_build_glyph_names_hash( CFF_Font            cff,
+                              FT_Service_PsCMaps  psnames )
+  {
+    FT_Memory  memory = cff->memory;
+    FT_Hash    hash   = NULL;
+    FT_UInt    i;
+    FT_Error   error;
+
+
+    if ( FT_QNEW( hash ) )
+      goto Exit;
+
+    error = ft_hash_str_init( hash, memory );
+    if ( error )
+      goto Fail;
+
+    for ( i = 0; i < cff->num_glyphs; i++ )
+    {
+      FT_UShort   sid = cff->charset.sids[i];
+      FT_String*  name;
+
+
+      if ( sid > 390 )
+        name = cff_index_get_string( cff, sid - 391 );
+      else
+        name = (FT_String *)psnames->adobe_std_strings( sid );
+
+      /* like a linear search, return the first glyph with that name */
+      if ( !name || ft_hash_str_lookup( name, hash ) )
+        continue;
+
+      error = ft_hash_str_insert( name, i, hash, memory );
+      if ( error )
+        goto Fail;
+    }
+
+    cff->glyph_names_hash = hash;
+
+  Exit:
+    return error;
+
+  Fail:
+    ft_hash_str_free( hash, memory );
+    FT_FREE( hash );
+    goto Exit;
+  }
+
+
   static FT_UInt
   cff_get_name_index( CFF_Face          face,
                       const FT_String*  glyph_name )
@@ -423,6 +474,19 @@
     if ( !psnames )
       return 0;
 
+    if ( !cff->glyph_names_hash )
+      (void)cff_build_glyph_names_hash( cff, psnames );
+
+    if ( cff->glyph_names_hash )
+    {
+      size_t*  gindex = ft_hash_str_lookup( glyph_name,
+                                            cff->glyph_names_hash );
+
+
+      return gindex ? (FT_UInt)*gindex : 0;
+    }
+
+    /* out of memory; fall back to a linear search */
     for ( i = 0; i < cff->num_glyphs; i++ )
     {
       sid = charset->sids[i];
@@ -2573,6 +2573,9 @@
     }
 
     FT_FREE( font->font_extra );
+
+    ft_hash_str_free( font->glyph_names_hash, memory );
+    FT_FREE( font->glyph_names_hash );
   }
 
 
@@ -54,8 +54,11 @@
     FT_Memory      memory       = face->root.memory;
     FT_ULong       glyph_length = 0;
     PSAux_Service  psaux        = (PSAux_Service)face->psaux;
+    PS_Driver      driver       = (PS_Driver)FT_FACE_DRIVER( face );
 
-    FT_Bool  force_scaling = FALSE;
+    CID_Charstring  cached        = NULL;
+    FT_Bool         decrypted     = FALSE;
+    FT_Bool         force_scaling = FALSE;
 
 #ifdef FT_CONFIG_OPTION_INCREMENTAL
     FT_Incremental_InterfaceRec  *inc =
@@ -65,6 +68,33 @@
 
     FT_TRACE1(( "cid_load_glyph: glyph index %u\n", glyph_index ));
 
+    /* Glyph charstrings are read from the stream and decrypted on every */
+    /* call; optionally keep them after first use.  The index can be out */
+    /* of range for accent characters of `seac'.                         */
+    if ( driver->charstring_cache      &&
+         glyph_index < cid->cid_count
+#ifdef FT_CONFIG_OPTION_INCREMENTAL
+         && !inc
+#endif
+       )
+    {
+      if ( !face->charstrings                                  &&
+           FT_NEW_ARRAY( face->charstrings, cid->cid_count ) )
+        goto Exit;
+
+      cached = face->charstrings + glyph_index;
+    }
+
+    if ( cached && cached->data )
+    {
+      fd_select    = cached->fd_select;
+      charstring   = cached->data;
+      glyph_length = cached->length;
+      decrypted    = TRUE;
+    }
+
+    else
+
 #ifdef FT_CONFIG_OPTION_INCREMENTAL
 
     /* For incremental fonts get the character data using */
@@ -167,9 +197,17 @@
       }
 
       /* Decrypt only if lenIV >= 0. */
-      if ( decoder->lenIV >= 0 )
+      if ( decoder->lenIV >= 0 && !decrypted )
         psaux->t1_decrypt( charstring, glyph_length, 4330 );
 
+      /* The cache takes ownership of the buffer. */
+      if ( cached && !cached->data )
+      {
+        cached->data      = charstring;
+        cached->length    = glyph_length;
+        cached->fd_select = (FT_UInt)fd_select;
+      }
+
       /* choose which renderer to use */
 #ifdef T1_CONFIG_OPTION_OLD_ENGINE
       if ( ( (PS_Driver)FT_FACE_DRIVER( face ) )->hinting_engine ==
@@ -247,7 +285,8 @@
 #endif /* FT_CONFIG_OPTION_INCREMENTAL */
 
   Exit:
-    FT_FREE( charstring );
+    if ( !cached || cached->data != charstring )
+      FT_FREE( charstring );
 
     ((CID_GlyphSlot)decoder->builder.glyph)->scaled = force_scaling;
 
@@ -234,6 +234,18 @@
       FT_FREE( face->subrs );
     }
 
+    /* release cached charstrings */
+    if ( face->charstrings )
+    {
+      FT_ULong  n;
+
+
+      for ( n = 0; n < cid->cid_count; n++ )
+        FT_FREE( face->charstrings[n].data );
+
+      FT_FREE( face->charstrings );
+    }
+
     /* release FontInfo strings */
     FT_FREE( info->version );
     FT_FREE( info->notice );
@@ -509,6 +521,8 @@
     else if ( driver->random_seed == 0 )
       driver->random_seed = 123456789;
 
+    driver->charstring_cache = FALSE;
+
     return FT_Err_Ok;
   }
 
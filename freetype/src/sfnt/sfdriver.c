@@ -190,7 +190,7 @@
   {
     TT_Face  ttface = (TT_Face)face;
 
-    FT_UInt  i, max_gid = FT_UINT_MAX;
+    FT_UInt  max_gid = FT_UINT_MAX;
 
 
     if ( face->num_glyphs < 0 )
@@ -201,20 +201,7 @@
       FT_TRACE0(( "Ignore glyph names for invalid GID 0x%08x - 0x%08lx\n",
                   FT_UINT_MAX, face->num_glyphs ));
 
-    for ( i = 0; i < max_gid; i++ )
-    {
-      FT_String*  gname;
-      FT_Error    error = tt_face_get_ps_name( ttface, i, &gname );
-
-
-      if ( error )
-        continue;
-
-      if ( !ft_strcmp( glyph_name, gname ) )
-        return i;
-    }
-
-    return 0;
+    return tt_face_get_ps_name_index( ttface, glyph_name, max_gid );
   }
 
 
@@ -444,6 +444,13 @@
       }
     }
     names->loaded = 0;
+
+    /* the hash keys point into the names just freed */
+    if ( names->name_index )
+    {
+      ft_hash_str_free( names->name_index, memory );
+      FT_FREE( names->name_index );
+    }
   }
 
 
@@ -555,6 +562,113 @@
     return FT_Err_Ok;
   }
 
+
+  static FT_Error
+  tt_face_build_ps_name_index( TT_Face  face,
+                               FT_UInt  num_glyphs )
+  {
+    FT_Memory      memory = face->root.memory;
+    TT_Post_Names  names  = &face->postscript_names;
+    FT_Hash        hash   = NULL;
+    FT_UInt        i;
+    FT_Error       error;
+
+
+    if ( FT_QNEW( hash ) )
+      goto Exit;
+
+    error = ft_hash_str_init( hash, memory );
+    if ( error )
+      goto Fail;
+
+    for ( i = 0; i < num_glyphs; i++ )
+    {
+      FT_String*  gname;
+
+
+      if ( tt_face_get_ps_name( face, i, &gname ) )
+        continue;
+
+      /* like a linear search, return the first glyph with that name */
+      if ( ft_hash_str_lookup( gname, hash ) )
+        continue;
+
+      error = ft_hash_str_insert( gname, i, hash, memory );
+      if ( error )
+        goto Fail;
+    }
+
+    names->name_index = hash;
+
+  Exit:
+    return error;
+
+  Fail:
+    ft_hash_str_free( hash, memory );
+    FT_FREE( hash );
+    goto Exit;
+  }
+
+
+  /**************************************************************************
+   *
+   * @Function:
+   *   tt_face_get_ps_name_index
+   *
+   * @Description:
+   *   Get the glyph index of a PostScript glyph name.  On the first call,
+   *   a hash table of all glyph names is built; if this fails, a linear
+   *   search is performed.
+   *
+   * @Input:
+   *   face ::
+   *     A handle to the parent face.
+   *
+   *   glyph_name ::
+   *     The glyph name.
+   *
+   *   num_glyphs ::
+   *     The number of glyphs to consider.
+   *
+   * @Return:
+   *   The glyph index.  0 means `undefined character code'.
+   */
+  FT_LOCAL_DEF( FT_UInt )
+  tt_face_get_ps_name_index( TT_Face           face,
+                             const FT_String*  glyph_name,
+                             FT_UInt           num_glyphs )
+  {
+    TT_Post_Names  names = &face->postscript_names;
+    FT_UInt        i;
+
+
+    if ( !names->name_index )
+      (void)tt_face_build_ps_name_index( face, num_glyphs );
+
+    if ( names->name_index )
+    {
+      size_t*  gindex = ft_hash_str_lookup( glyph_name, names->name_index );
+
+
+      return gindex ? (FT_UInt)*gindex : 0;
+    }
+
+    for ( i = 0; i < num_glyphs; i++ )
+    {
+      FT_String*  gname;
+      FT_Error    error = tt_face_get_ps_name( face, i, &gname );
+
+
+      if ( error )
+        continue;
+
+      if ( !ft_strcmp( glyph_name, gname ) )
+        return i;
+    }
+
+    return 0;
+  }
+
 #else /* !TT_CONFIG_OPTION_POSTSCRIPT_NAMES */
 
   /* ANSI C doesn't like empty source files */
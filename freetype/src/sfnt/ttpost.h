@@ -34,6 +34,11 @@ FT_BEGIN_HEADER
                        FT_UInt      idx,
                        FT_String**  PSname );
 
+  FT_LOCAL( FT_UInt )
+  tt_face_get_ps_name_index( TT_Face           face,
+                             const FT_String*  glyph_name,
+                             FT_UInt           num_glyphs );
+
   FT_LOCAL( void )
   tt_face_free_ps_names( TT_Face  face );
 
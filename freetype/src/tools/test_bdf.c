@@ -0,0 +1,252 @@
+#include <freetype/freetype.h>
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>    /* for clock() */
+
+/* SunOS 4.1.* does not define CLOCKS_PER_SEC, so include <sys/param.h> */
+/* to get the HZ macro which is the equivalent.                         */
+#if defined(__sun__) && !defined(SVR4) && !defined(__SVR4)
+#include <sys/param.h>
+#define CLOCKS_PER_SEC HZ
+#endif
+
+  static long
+  get_time( void )
+  {
+    return clock() * 10000L / CLOCKS_PER_SEC;
+  }
+
+
+
+
+  /* Load a BDF font from memory and through a stream with a read     */
+  /* callback, check that both give the same glyph bitmaps, and report */
+  /* load times.                                                       */
+  /*                                                                   */
+  /* Since only the public API is used, build this program against an  */
+  /* older library as well to measure the gain of a change to the BDF */
+  /* driver; the checksums of both builds must agree.                  */
+  /*                                                                   */
+  /* Usage: test_bdf [font.bdf]                                        */
+  /*                                                                   */
+  /* Without an argument, a Unifont-sized synthetic font (65536        */
+  /* glyphs of 16x16 pixels) is generated in memory.                   */
+
+#define REPEAT  5
+
+
+  static unsigned char*  font_data;
+  static unsigned long   font_size;
+
+
+  static void
+  make_font( void )
+  {
+    unsigned long  max_size = 65536UL * 192 + 1024;
+    unsigned long  n;
+    int            row;
+    char*          p;
+
+
+    font_data = (unsigned char*)malloc( max_size );
+    if ( !font_data )
+      exit( 1 );
+
+    p  = (char*)font_data;
+    p += sprintf( p,
+                  "STARTFONT 2.1\n"
+                  "FONT -test-synthetic-medium-r-normal--16-160-75-75-c-80"
+                  "-iso10646-1\n"
+                  "SIZE 16 75 75\n"
+                  "FONTBOUNDINGBOX 16 16 0 -2\n"
+                  "STARTPROPERTIES 2\n"
+                  "FONT_ASCENT 14\n"
+                  "FONT_DESCENT 2\n"
+                  "ENDPROPERTIES\n"
+                  "CHARS 65536\n" );
+
+    for ( n = 0; n < 65536UL; n++ )
+    {
+      p += sprintf( p,
+                    "STARTCHAR uni%04lX\n"
+                    "ENCODING %lu\n"
+                    "SWIDTH 1000 0\n"
+                    "DWIDTH 16 0\n"
+                    "BBX 16 16 0 -2\n"
+                    "BITMAP\n",
+                    n, n );
+
+      for ( row = 0; row < 16; row++ )
+        p += sprintf( p, "%04lX\n",
+                      ( ( n * 2654435761UL ) >> row ) & 0xFFFFUL );
+
+      p += sprintf( p, "ENDCHAR\n" );
+    }
+
+    p += sprintf( p, "ENDFONT\n" );
+
+    font_size = (unsigned long)( p - (char*)font_data );
+  }
+
+
+  static void
+  read_font( const char*  filename )
+  {
+    FILE*  file = fopen( filename, "rb" );
+
+
+    if ( !file )
+    {
+      fprintf( stderr, "cannot open `%s'\n", filename );
+      exit( 1 );
+    }
+
+    fseek( file, 0, SEEK_END );
+    font_size = (unsigned long)ftell( file );
+    fseek( file, 0, SEEK_SET );
+
+    font_data = (unsigned char*)malloc( font_size );
+    if ( !font_data                                        ||
+         fread( font_data, 1, font_size, file ) != font_size )
+      exit( 1 );
+
+    fclose( file );
+  }
+
+
+  /* A stream without `base', read in chunks by the driver. */
+  static unsigned long
+  stream_read( FT_Stream       stream,
+               unsigned long   offset,
+               unsigned char*  buffer,
+               unsigned long   count )
+  {
+    (void)stream;
+
+    if ( offset >= font_size )
+      return 0;
+
+    if ( count > font_size - offset )
+      count = font_size - offset;
+
+    if ( count )
+      memcpy( buffer, font_data + offset, count );
+
+    return count;
+  }
+
+
+  static FT_Error
+  open_face( FT_Library  library,
+             int         use_stream,
+             FT_Face    *aface )
+  {
+    static FT_StreamRec  stream;
+    FT_Open_Args         args;
+
+
+    if ( !use_stream )
+      return FT_New_Memory_Face( library, font_data, (FT_Long)font_size,
+                                 0, aface );
+
+    memset( &stream, 0, sizeof ( stream ) );
+    stream.size = font_size;
+    stream.read = stream_read;
+
+    args.flags  = FT_OPEN_STREAM;
+    args.stream = &stream;
+
+    return FT_Open_Face( library, &args, 0, aface );
+  }
+
+
+  /* A checksum over all glyph bitmaps to verify both loads agree. */
+  static unsigned long
+  checksum_face( FT_Face  face )
+  {
+    unsigned long  sum = 0;
+    FT_Long        gindex;
+
+
+    for ( gindex = 0; gindex < face->num_glyphs; gindex++ )
+    {
+      FT_Bitmap*  bitmap;
+      int         y, x;
+
+
+      if ( FT_Load_Glyph( face, (FT_UInt)gindex, FT_LOAD_DEFAULT ) )
+        continue;
+
+      bitmap = &face->glyph->bitmap;
+      for ( y = 0; y < (int)bitmap->rows; y++ )
+        for ( x = 0; x < abs( bitmap->pitch ); x++ )
+          sum = sum * 31 + bitmap->buffer[y * bitmap->pitch + x];
+    }
+
+    return sum;
+  }
+
+
+  static void
+  profile_load( FT_Library   library,
+                int          use_stream,
+                const char*  label )
+  {
+    FT_Face        face = NULL;
+    unsigned long  sum  = 0;
+    long           count;
+    long           time0;
+
+
+    time0 = get_time();
+    for ( count = REPEAT; count > 0; count-- )
+    {
+      if ( open_face( library, use_stream, &face ) )
+      {
+        fprintf( stderr, "%s: cannot load font\n", label );
+        exit( 1 );
+      }
+
+      if ( count > 1 )
+        FT_Done_Face( face );
+    }
+    time0 = get_time() - time0;
+
+    sum = checksum_face( face );
+
+    printf( "%-8s time = %6.3f  glyphs = %ld  checksum = %08lX\n",
+            label,
+            ( (double)time0 / 10000.0 ) / REPEAT,
+            face->num_glyphs,
+            sum & 0xFFFFFFFFUL );
+
+    FT_Done_Face( face );
+  }
+
+
+  int  main( int  argc, char**  argv )
+  {
+    FT_Library  library;
+
+
+    if ( argc > 1 )
+      read_font( argv[1] );
+    else
+      make_font();
+
+    if ( FT_Init_FreeType( &library ) )
+      return 1;
+
+    printf( "font size = %lu bytes, %d loads each\n", font_size, REPEAT );
+
+    profile_load( library, 1, "stream" );
+    profile_load( library, 0, "memory" );
+
+    FT_Done_FreeType( library );
+    free( font_data );
+
+    return 0;
+  }
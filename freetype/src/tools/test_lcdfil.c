@@ -0,0 +1,115 @@
+#include <freetype/freetype.h>
+#include <freetype/ftlcdfil.h>
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>    /* for clock() */
+
+/* SunOS 4.1.* does not define CLOCKS_PER_SEC, so include <sys/param.h> */
+/* to get the HZ macro which is the equivalent.                         */
+#if defined(__sun__) && !defined(SVR4) && !defined(__SVR4)
+#include <sys/param.h>
+#define CLOCKS_PER_SEC HZ
+#endif
+
+  static long
+  get_time( void )
+  {
+    return clock() * 10000L / CLOCKS_PER_SEC;
+  }
+
+
+
+
+  /* Measure the cost of the LCD FIR filter (`ft_lcd_filter_fir').      */
+  /*                                                                    */
+  /* Usage: test_lcdfil font [pixel_size]                               */
+  /*                                                                    */
+  /* All glyphs are rendered in LCD and LCD_V mode, once with the       */
+  /* default filter and once without filtering; the difference is the   */
+  /* time spent in the filter.  FreeType must be compiled with          */
+  /* FT_CONFIG_OPTION_SUBPIXEL_RENDERING, otherwise no filter is used.  */
+
+#define REPEAT  20
+
+
+  static long
+  profile_render( FT_Face         face,
+                  FT_Render_Mode  mode )
+  {
+    long     count;
+    long     time0;
+    FT_Long  gindex;
+
+
+    time0 = get_time();
+    for ( count = REPEAT; count > 0; count-- )
+      for ( gindex = 0; gindex < face->num_glyphs; gindex++ )
+      {
+        if ( FT_Load_Glyph( face, (FT_UInt)gindex, FT_LOAD_NO_HINTING ) )
+          continue;
+        FT_Render_Glyph( face->glyph, mode );
+      }
+
+    return get_time() - time0;
+  }
+
+
+  int  main( int  argc, char**  argv )
+  {
+    FT_Library  library;
+    FT_Face     face;
+    FT_UInt     size = 64;
+    long        filtered, unfiltered;
+    int         i;
+
+    static const struct
+    {
+      FT_Render_Mode  mode;
+      const char*     name;
+
+    } modes[2] =
+    {
+      { FT_RENDER_MODE_LCD,   "LCD"   },
+      { FT_RENDER_MODE_LCD_V, "LCD_V" }
+    };
+
+
+    if ( argc < 2 )
+    {
+      fprintf( stderr, "usage: test_lcdfil font [pixel_size]\n" );
+      return 1;
+    }
+
+    if ( argc > 2 )
+      size = (FT_UInt)atoi( argv[2] );
+
+    if ( FT_Init_FreeType( &library )                    ||
+         FT_New_Face( library, argv[1], 0, &face )       ||
+         FT_Set_Pixel_Sizes( face, 0, size )             )
+      return 1;
+
+    if ( FT_Library_SetLcdFilter( library, FT_LCD_FILTER_DEFAULT ) )
+      printf( "subpixel rendering not compiled in; no filtering\n" );
+
+    for ( i = 0; i < 2; i++ )
+    {
+      FT_Library_SetLcdFilter( library, FT_LCD_FILTER_DEFAULT );
+      filtered = profile_render( face, modes[i].mode );
+
+      FT_Library_SetLcdFilter( library, FT_LCD_FILTER_NONE );
+      unfiltered = profile_render( face, modes[i].mode );
+
+      printf( "%-5s filtered = %6.3f  unfiltered = %6.3f  filter = %6.3f\n",
+              modes[i].name,
+              (double)filtered / 10000.0,
+              (double)unfiltered / 10000.0,
+              (double)( filtered - unfiltered ) / 10000.0 );
+    }
+
+    FT_Done_Face( face );
+    FT_Done_FreeType( library );
+
+    return 0;
+  }
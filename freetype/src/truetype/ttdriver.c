@@ -108,6 +108,99 @@
       return error;
     }
 
+    if ( !ft_strcmp( property_name, "component-cache" ) )
+    {
+#ifdef FT_CONFIG_OPTION_ENVIRONMENT_PROPERTIES
+      if ( value_is_string )
+      {
+        const char*  s  = (const char*)value;
+        long         cc = ft_strtol( s, NULL, 10 );
+
+
+        driver->component_cache = FT_BOOL( cc );
+      }
+      else
+#endif
+      {
+        FT_Bool*  component_cache = (FT_Bool*)value;
+
+
+        driver->component_cache = *component_cache;
+      }
+
+      return error;
+    }
+
+    if ( !ft_strcmp( property_name, "prep-cache" ) )
+    {
+#ifdef FT_CONFIG_OPTION_ENVIRONMENT_PROPERTIES
+      if ( value_is_string )
+      {
+        const char*  s  = (const char*)value;
+        long         pc = ft_strtol( s, NULL, 10 );
+
+
+        driver->prep_cache = FT_BOOL( pc );
+      }
+      else
+#endif
+      {
+        FT_Bool*  prep_cache = (FT_Bool*)value;
+
+
+        driver->prep_cache = *prep_cache;
+      }
+
+      return error;
+    }
+
+    if ( !ft_strcmp( property_name, "max-runnable-opcodes" ) )
+    {
+      FT_ULong  max_runnable_opcodes;
+
+
+#ifdef FT_CONFIG_OPTION_ENVIRONMENT_PROPERTIES
+      if ( value_is_string )
+      {
+        const char*  s = (const char*)value;
+
+
+        max_runnable_opcodes = (FT_ULong)ft_strtol( s, NULL, 10 );
+      }
+      else
+#endif
+        max_runnable_opcodes = *(FT_ULong*)value;
+
+      if ( !max_runnable_opcodes )
+        return FT_THROW( Invalid_Argument );
+
+      driver->max_runnable_opcodes = max_runnable_opcodes;
+
+      return error;
+    }
+
+    if ( !ft_strcmp( property_name, "aborted-runs" ) )
+    {
+      FT_ULong  aborted_runs;
+
+
+#ifdef FT_CONFIG_OPTION_ENVIRONMENT_PROPERTIES
+      if ( value_is_string )
+      {
+        const char*  s = (const char*)value;
+
+
+        aborted_runs = (FT_ULong)ft_strtol( s, NULL, 10 );
+      }
+      else
+#endif
+        aborted_runs = *(FT_ULong*)value;
+
+      driver->aborted_runs = aborted_runs;
+
+      return error;
+    }
+
     FT_TRACE2(( "tt_property_set: missing property `%s'\n",
                 property_name ));
     return FT_THROW( Missing_Property );
@@ -135,6 +228,46 @@
       return error;
     }
 
+    if ( !ft_strcmp( property_name, "component-cache" ) )
+    {
+      FT_Bool*  val = (FT_Bool*)value;
+
+
+      *val = driver->component_cache;
+
+      return error;
+    }
+
+    if ( !ft_strcmp( property_name, "prep-cache" ) )
+    {
+      FT_Bool*  val = (FT_Bool*)value;
+
+
+      *val = driver->prep_cache;
+
+      return error;
+    }
+
+    if ( !ft_strcmp( property_name, "max-runnable-opcodes" ) )
+    {
+      FT_ULong*  val = (FT_ULong*)value;
+
+
+      *val = driver->max_runnable_opcodes;
+
+      return error;
+    }
+
+    if ( !ft_strcmp( property_name, "aborted-runs" ) )
+    {
+      FT_ULong*  val = (FT_ULong*)value;
+
+
+      *val = driver->aborted_runs;
+
+      return error;
+    }
+
     FT_TRACE2(( "tt_property_get: missing property `%s'\n",
                 property_name ));
     return FT_THROW( Missing_Property );
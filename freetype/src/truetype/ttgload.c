@@ -1566,6 +1566,193 @@
   }
 
 
+  /**************************************************************************
+   *
+   * Component cache.
+   *
+   * Composite glyphs (accented letters, CJK fonts built from radicals) load
+   * the same simple glyphs over and over again as components.  If the
+   * `component-cache' property is set, a simple glyph loaded as a component
+   * is stored in its scaled and hinted form in the size object, together
+   * with the loader state that it changes; subsequent composites using the
+   * same component simply append a copy of it.
+   *
+   * Components are only cached if the result is fully determined by the
+   * glyph index, the size, the load flags, and the variation coordinates.
+   * This excludes the incremental interface and the Infinality interpreter
+   * (whose tweaks depend on the outer glyph).
+   */
+  static FT_Bool
+  tt_loader_uses_component_cache( TT_Loader  loader )
+  {
+    TT_Face    face   = loader->face;
+    TT_Driver  driver = (TT_Driver)FT_FACE_DRIVER( face );
+    TT_Size    size   = loader->size;
+
+
+    if ( !driver->component_cache || !size )
+      return FALSE;
+
+#ifdef FT_CONFIG_OPTION_INCREMENTAL
+    if ( face->root.internal->incremental_interface )
+      return FALSE;
+#endif
+
+#ifdef TT_SUPPORT_SUBPIXEL_HINTING_INFINALITY
+    if ( driver->interpreter_version == TT_INTERPRETER_VERSION_38 )
+      return FALSE;
+#endif
+
+    /* entries made with other settings are useless now */
+    if ( size->components.load_flags          != loader->load_flags     ||
+         size->components.interpreter_version != driver->interpreter_version )
+    {
+      tt_size_flush_components( size );
+
+      size->components.load_flags          = loader->load_flags;
+      size->components.interpreter_version = driver->interpreter_version;
+    }
+
+    return TRUE;
+  }
+
+
+  static TT_Component
+  tt_component_lookup( TT_Loader  loader,
+                       FT_UInt    glyph_index )
+  {
+    TT_ComponentCache  cache = &loader->size->components;
+    size_t*            pos;
+
+
+    if ( !cache->index_ready )
+      return NULL;
+
+    pos = ft_hash_num_lookup( (FT_Int)glyph_index, &cache->index );
+    if ( !pos )
+      return NULL;
+
+    return cache->entries + *pos;
+  }
+
+
+  /* Store the component just processed in `gloader->current'.  Errors */
+  /* are not fatal: the component simply doesn't get cached.           */
+  static void
+  tt_component_store( TT_Loader  loader,
+                      FT_UInt    glyph_index,
+                      FT_Bool    overlap )
+  {
+    TT_ComponentCache  cache   = &loader->size->components;
+    FT_Memory          memory  = loader->face->root.memory;
+    FT_Outline*        outline = &loader->gloader->current.outline;
+    TT_Component       entry;
+    FT_Error           error;
+
+
+    if ( !cache->index_ready )
+    {
+      if ( ft_hash_num_init( &cache->index, memory ) )
+        return;
+      cache->index_ready = TRUE;
+    }
+
+    if ( cache->num_entries >= cache->max_entries )
+    {
+      FT_UInt  new_max = cache->max_entries ? cache->max_entries * 2 : 64;
+
+
+      if ( FT_RENEW_ARRAY( cache->entries, cache->max_entries, new_max ) )
+        return;
+      cache->max_entries = new_max;
+    }
+
+    entry = cache->entries + cache->num_entries;
+    FT_ZERO( entry );
+
+    if ( FT_QNEW_ARRAY( entry->points, outline->n_points )     ||
+         FT_QNEW_ARRAY( entry->tags, outline->n_points )       ||
+         FT_QNEW_ARRAY( entry->contours, outline->n_contours ) )
+      goto Fail;
+
+    FT_ARRAY_COPY( entry->points, outline->points, outline->n_points );
+    FT_ARRAY_COPY( entry->tags, outline->tags, outline->n_points );
+    FT_ARRAY_COPY( entry->contours, outline->contours, outline->n_contours );
+
+    entry->glyph_index  = glyph_index;
+    entry->n_points     = outline->n_points;
+    entry->n_contours   = outline->n_contours;
+    entry->overlap      = overlap;
+    entry->bbox         = loader->bbox;
+    entry->left_bearing = loader->left_bearing;
+    entry->advance      = loader->advance;
+    entry->top_bearing  = loader->top_bearing;
+    entry->vadvance     = loader->vadvance;
+    entry->pp1          = loader->pp1;
+    entry->pp2          = loader->pp2;
+    entry->pp3          = loader->pp3;
+    entry->pp4          = loader->pp4;
+
+    if ( ft_hash_num_insert( (FT_Int)glyph_index,
+                             cache->num_entries,
+                             &cache->index,
+                             memory ) )
+      goto Fail;
+
+    cache->num_entries++;
+    return;
+
+  Fail:
+    FT_FREE( entry->points );
+    FT_FREE( entry->tags );
+    FT_FREE( entry->contours );
+  }
+
+
+  /* Append a cached component to the glyph loader and restore the */
+  /* loader state as if the component had been loaded normally.    */
+  static FT_Error
+  tt_component_replay( TT_Loader     loader,
+                       TT_Component  entry )
+  {
+    FT_GlyphLoader  gloader = loader->gloader;
+    FT_Outline*     outline = &gloader->current.outline;
+    FT_Error        error;
+
+
+    error = FT_GLYPHLOADER_CHECK_POINTS( gloader,
+                                         entry->n_points + 4,
+                                         entry->n_contours );
+    if ( error )
+      return error;
+
+    FT_ARRAY_COPY( outline->points, entry->points, entry->n_points );
+    FT_ARRAY_COPY( outline->tags, entry->tags, entry->n_points );
+    FT_ARRAY_COPY( outline->contours, entry->contours, entry->n_contours );
+
+    outline->n_points   = entry->n_points;
+    outline->n_contours = entry->n_contours;
+
+    if ( entry->overlap )
+      gloader->base.outline.flags |= FT_OUTLINE_OVERLAP;
+
+    loader->n_contours   = entry->n_contours;
+    loader->bbox         = entry->bbox;
+    loader->left_bearing = entry->left_bearing;
+    loader->advance      = entry->advance;
+    loader->top_bearing  = entry->top_bearing;
+    loader->vadvance     = entry->vadvance;
+    loader->pp1          = entry->pp1;
+    loader->pp2          = entry->pp2;
+    loader->pp3          = entry->pp3;
+    loader->pp4          = entry->pp4;
+
+    FT_GlyphLoader_Add( gloader );
+
+    return FT_Err_Ok;
+  }
+
+
   /**************************************************************************
    *
    * @Function:
@@ -1587,7 +1774,8 @@
     TT_Face         face    = loader->face;
     FT_GlyphLoader  gloader = loader->gloader;
 
-    FT_Bool  opened_frame = 0;
+    FT_Bool  opened_frame    = 0;
+    FT_Bool  cache_component = 0;
 
 #ifdef FT_CONFIG_OPTION_INCREMENTAL
     FT_StreamRec    inc_stream;
@@ -1620,6 +1808,22 @@
 
     loader->glyph_index = glyph_index;
 
+    /* components are never loaded `header only' */
+    if ( recurse_count && tt_loader_uses_component_cache( loader ) )
+    {
+      TT_Component  component = tt_component_lookup( loader, glyph_index );
+
+
+      if ( component )
+      {
+        FT_TRACE5(( "  using cached component\n" ));
+        error = tt_component_replay( loader, component );
+        goto Exit;
+      }
+
+      cache_component = 1;
+    }
+
     if ( loader->load_flags & FT_LOAD_NO_SCALE )
     {
       x_scale = 0x10000L;
@@ -1799,7 +2003,18 @@
 
     if ( loader->n_contours > 0 )
     {
+      FT_Int   old_flags = gloader->base.outline.flags;
+      FT_Bool  overlap;
+
+
+      /* to see whether this glyph sets the overlap flag */
+      gloader->base.outline.flags &= ~FT_OUTLINE_OVERLAP;
+
       error = face->read_simple_glyph( loader );
+
+      overlap = FT_BOOL( gloader->base.outline.flags & FT_OUTLINE_OVERLAP );
+      gloader->base.outline.flags |= old_flags & FT_OUTLINE_OVERLAP;
+
       if ( error )
         goto Exit;
 
@@ -1811,6 +2026,9 @@
       if ( error )
         goto Exit;
 
+      if ( cache_component )
+        tt_component_store( loader, glyph_index, overlap );
+
       FT_GlyphLoader_Add( gloader );
     }
 
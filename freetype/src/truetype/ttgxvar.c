@@ -1461,6 +1461,21 @@
   }
 
 
+  static FT_Error
+  tt_size_flush_components_iterator( FT_ListNode  node,
+                                     void*        user )
+  {
+    TT_Size  size = (TT_Size)node->data;
+
+    FT_UNUSED( user );
+
+
+    tt_size_flush_components( size );
+
+    return FT_Err_Ok;
+  }
+
+
   static FT_Error
   tt_size_reset_iterator( FT_ListNode  node,
                           void*        user )
@@ -2900,6 +2915,11 @@
 
     face->doblend = TRUE;
 
+    /* components cached for the old coordinates are stale now */
+    FT_List_Iterate( &face->root.sizes_list,
+                     tt_size_flush_components_iterator,
+                     NULL );
+
     if ( face->cvt )
     {
       switch ( manageCvt )
@@ -7742,6 +7742,7 @@
   TT_RunIns( TT_ExecContext  exc )
   {
     FT_ULong   ins_counter = 0;  /* executed instructions counter */
+    FT_ULong   max_ins_counter;
     FT_ULong   num_twilight_points;
     FT_UShort  i;
 
@@ -7759,6 +7760,9 @@
 #endif /* TT_SUPPORT_SUBPIXEL_HINTING_INFINALITY */
 
 
+    max_ins_counter =
+      ( (TT_Driver)FT_FACE_DRIVER( exc->face ) )->max_runnable_opcodes;
+
     /* We restrict the number of twilight points to a reasonable,     */
     /* heuristic value to avoid slow execution of malformed bytecode. */
     num_twilight_points = FT_MAX( 30,
@@ -8565,8 +8569,10 @@
 
       /* increment instruction counter and check if we didn't */
       /* run this program for too long (e.g. infinite loops). */
-      if ( ++ins_counter > TT_CONFIG_OPTION_MAX_RUNNABLE_OPCODES )
+      if ( ++ins_counter > max_ins_counter )
       {
+        ( (TT_Driver)FT_FACE_DRIVER( exc->face ) )->aborted_runs++;
+
         exc->error = FT_THROW( Execution_Too_Long );
         goto LErrorLabel_;
       }
@@ -851,6 +851,10 @@
     FT_FREE( face->cvt );
     face->cvt_size = 0;
 
+#ifdef TT_USE_BYTECODE_INTERPRETER
+    tt_face_done_prep_cache( face );
+#endif
+
     /* freeing the programs */
     FT_FRAME_RELEASE( face->font_program );
     FT_FRAME_RELEASE( face->cvt_program );
@@ -966,6 +970,270 @@
   }
 
 
+  /* The normalized variation coordinates, which determine the CVT. */
+  static FT_UInt
+  tt_face_get_coords( TT_Face     face,
+                      FT_Fixed*  *coords )
+  {
+#ifdef TT_CONFIG_OPTION_GX_VAR_SUPPORT
+    if ( face->blend && face->blend->normalizedcoords )
+    {
+      *coords = face->blend->normalizedcoords;
+      return face->blend->num_axis;
+    }
+#else
+    FT_UNUSED( face );
+#endif
+
+    *coords = NULL;
+    return 0;
+  }
+
+
+  static FT_Bool
+  tt_prep_snapshot_matches( TT_PrepSnapshot  snapshot,
+                            TT_Size          size,
+                            FT_Bool          pedantic )
+  {
+    TT_Face           face      = (TT_Face)size->root.face;
+    TT_Driver         driver    = (TT_Driver)FT_FACE_DRIVER( face );
+    TT_ExecContext    exec      = size->context;
+    FT_Size_Metrics*  metrics   = &size->root.metrics;
+    TT_Size_Metrics*  ttmetrics = &size->ttmetrics;
+    FT_Fixed*         coords;
+    FT_UInt           num_coords;
+
+
+    if ( snapshot->x_ppem     != metrics->x_ppem   ||
+         snapshot->y_ppem     != metrics->y_ppem   ||
+         snapshot->x_scale    != metrics->x_scale  ||
+         snapshot->y_scale    != metrics->y_scale  ||
+         snapshot->point_size != size->point_size  )
+      return FALSE;
+
+    if ( snapshot->ttmetrics.x_ratio   != ttmetrics->x_ratio   ||
+         snapshot->ttmetrics.y_ratio   != ttmetrics->y_ratio   ||
+         snapshot->ttmetrics.ppem      != ttmetrics->ppem      ||
+         snapshot->ttmetrics.ratio     != ttmetrics->ratio     ||
+         snapshot->ttmetrics.scale     != ttmetrics->scale     ||
+         snapshot->ttmetrics.rotated   != ttmetrics->rotated   ||
+         snapshot->ttmetrics.stretched != ttmetrics->stretched )
+      return FALSE;
+
+    if ( snapshot->interpreter_version != driver->interpreter_version ||
+         snapshot->pedantic            != pedantic                    ||
+         snapshot->grayscale           != exec->grayscale             )
+      return FALSE;
+
+#ifdef TT_SUPPORT_SUBPIXEL_HINTING_MINIMAL
+    if ( snapshot->subpixel_hinting_lean != exec->subpixel_hinting_lean ||
+         snapshot->vertical_lcd_lean     != exec->vertical_lcd_lean     ||
+         snapshot->grayscale_cleartype   != exec->grayscale_cleartype   )
+      return FALSE;
+#endif
+
+    num_coords = tt_face_get_coords( face, &coords );
+    if ( snapshot->num_coords != num_coords )
+      return FALSE;
+    if ( num_coords                                              &&
+         ft_memcmp( snapshot->coords, coords,
+                    num_coords * sizeof ( FT_Fixed ) )           )
+      return FALSE;
+
+    return TRUE;
+  }
+
+
+  static void
+  tt_prep_snapshot_free( TT_PrepSnapshot  snapshot,
+                         FT_Memory        memory )
+  {
+    FT_FREE( snapshot->coords );
+    FT_FREE( snapshot->cvt );
+    FT_FREE( snapshot->storage );
+    FT_FREE( snapshot->twilight_org );
+    FT_FREE( snapshot->twilight_cur );
+    FT_FREE( snapshot->twilight_orus );
+    FT_FREE( snapshot->twilight_tags );
+    FT_FREE( snapshot->function_defs );
+    FT_FREE( snapshot->instruction_defs );
+  }
+
+
+  /* Return the snapshot matching the current state of `size', if any. */
+  static TT_PrepSnapshot
+  tt_prep_cache_lookup( TT_Size  size,
+                        FT_Bool  pedantic )
+  {
+    TT_Face       face  = (TT_Face)size->root.face;
+    TT_PrepCache  cache = (TT_PrepCache)face->prep_cache;
+    FT_UInt       n;
+
+
+    if ( !cache )
+      return NULL;
+
+    for ( n = 0; n < cache->num_entries; n++ )
+      if ( tt_prep_snapshot_matches( cache->entries + n, size, pedantic ) )
+        return cache->entries + n;
+
+    return NULL;
+  }
+
+
+  /* Store the state after `prep'; `exec' still holds its results. */
+  static void
+  tt_prep_cache_insert( TT_Size   size,
+                        FT_Bool   pedantic,
+                        FT_Error  prep_error )
+  {
+    TT_Face             face   = (TT_Face)size->root.face;
+    TT_Driver           driver = (TT_Driver)FT_FACE_DRIVER( face );
+    TT_ExecContext      exec   = size->context;
+    TT_GlyphZone        zone   = &exec->twilight;
+    FT_Memory           memory = face->root.memory;
+    TT_PrepCache        cache  = (TT_PrepCache)face->prep_cache;
+    TT_PrepSnapshotRec  snapshot;
+    FT_Fixed*           coords;
+    FT_UInt             num_coords;
+    FT_Error            error;
+
+
+    if ( !cache )
+    {
+      if ( FT_NEW( cache ) )
+        return;
+      face->prep_cache = cache;
+    }
+
+    FT_ZERO( &snapshot );
+
+    num_coords = tt_face_get_coords( face, &coords );
+
+    if ( FT_QNEW_ARRAY( snapshot.coords, num_coords )              ||
+         FT_QNEW_ARRAY( snapshot.cvt, exec->cvtSize )              ||
+         FT_QNEW_ARRAY( snapshot.storage, exec->storeSize )        ||
+         FT_QNEW_ARRAY( snapshot.twilight_org, zone->n_points )    ||
+         FT_QNEW_ARRAY( snapshot.twilight_cur, zone->n_points )    ||
+         FT_QNEW_ARRAY( snapshot.twilight_orus, zone->n_points )   ||
+         FT_QNEW_ARRAY( snapshot.twilight_tags, zone->n_points )   ||
+         FT_QNEW_ARRAY( snapshot.function_defs, exec->maxFDefs )   ||
+         FT_QNEW_ARRAY( snapshot.instruction_defs, exec->maxIDefs ) )
+    {
+      /* not fatal; `prep' simply runs again next time */
+      tt_prep_snapshot_free( &snapshot, memory );
+      return;
+    }
+
+    snapshot.x_ppem              = size->root.metrics.x_ppem;
+    snapshot.y_ppem              = size->root.metrics.y_ppem;
+    snapshot.x_scale             = size->root.metrics.x_scale;
+    snapshot.y_scale             = size->root.metrics.y_scale;
+    snapshot.point_size          = size->point_size;
+    snapshot.ttmetrics           = size->ttmetrics;
+    snapshot.interpreter_version = driver->interpreter_version;
+    snapshot.pedantic            = pedantic;
+    snapshot.grayscale           = exec->grayscale;
+#ifdef TT_SUPPORT_SUBPIXEL_HINTING_MINIMAL
+    snapshot.subpixel_hinting_lean = exec->subpixel_hinting_lean;
+    snapshot.vertical_lcd_lean     = exec->vertical_lcd_lean;
+    snapshot.grayscale_cleartype   = exec->grayscale_cleartype;
+#endif
+    snapshot.num_coords = num_coords;
+    FT_ARRAY_COPY( snapshot.coords, coords, num_coords );
+
+    snapshot.error = prep_error;
+    snapshot.GS    = exec->GS;
+
+    FT_ARRAY_COPY( snapshot.cvt, exec->cvt, exec->cvtSize );
+    FT_ARRAY_COPY( snapshot.storage, exec->storage, exec->storeSize );
+
+    FT_ARRAY_COPY( snapshot.twilight_org, zone->org, zone->n_points );
+    FT_ARRAY_COPY( snapshot.twilight_cur, zone->cur, zone->n_points );
+    FT_ARRAY_COPY( snapshot.twilight_orus, zone->orus, zone->n_points );
+    FT_ARRAY_COPY( snapshot.twilight_tags, zone->tags, zone->n_points );
+
+    snapshot.num_function_defs = exec->numFDefs;
+    snapshot.max_func          = exec->maxFunc;
+    FT_ARRAY_COPY( snapshot.function_defs, exec->FDefs, exec->maxFDefs );
+
+    snapshot.num_instruction_defs = exec->numIDefs;
+    snapshot.max_ins              = exec->maxIns;
+    FT_ARRAY_COPY( snapshot.instruction_defs, exec->IDefs,
+                   exec->maxIDefs );
+
+    /* replace the oldest entry if the cache is full */
+    if ( cache->num_entries < TT_PREP_CACHE_SIZE )
+      cache->num_entries++;
+    else
+      tt_prep_snapshot_free( cache->entries + cache->next, memory );
+
+    cache->entries[cache->next] = snapshot;
+    cache->next                 = ( cache->next + 1 ) % TT_PREP_CACHE_SIZE;
+  }
+
+
+  /* The counterpart of `tt_prep_cache_insert'. */
+  static void
+  tt_prep_snapshot_restore( TT_PrepSnapshot  snapshot,
+                            TT_Size          size )
+  {
+    TT_ExecContext  exec = size->context;
+    TT_GlyphZone    zone = &exec->twilight;
+
+
+    exec->GS = snapshot->GS;
+
+    FT_ARRAY_COPY( exec->cvt, snapshot->cvt, exec->cvtSize );
+    FT_ARRAY_COPY( exec->storage, snapshot->storage, exec->storeSize );
+
+    FT_ARRAY_COPY( zone->org, snapshot->twilight_org, zone->n_points );
+    FT_ARRAY_COPY( zone->cur, snapshot->twilight_cur, zone->n_points );
+    FT_ARRAY_COPY( zone->orus, snapshot->twilight_orus, zone->n_points );
+    FT_ARRAY_COPY( zone->tags, snapshot->twilight_tags, zone->n_points );
+
+    exec->numFDefs = snapshot->num_function_defs;
+    exec->maxFunc  = snapshot->max_func;
+    FT_ARRAY_COPY( exec->FDefs, snapshot->function_defs, exec->maxFDefs );
+
+    exec->numIDefs = snapshot->num_instruction_defs;
+    exec->maxIns   = snapshot->max_ins;
+    FT_ARRAY_COPY( exec->IDefs, snapshot->instruction_defs,
+                   exec->maxIDefs );
+  }
+
+
+  /**************************************************************************
+   *
+   * @Function:
+   *   tt_face_done_prep_cache
+   *
+   * @Description:
+   *   Discard all `prep' snapshots of a face object.
+   *
+   * @Input:
+   *   face ::
+   *     A handle to the target face object.
+   */
+  FT_LOCAL_DEF( void )
+  tt_face_done_prep_cache( TT_Face  face )
+  {
+    TT_PrepCache  cache  = (TT_PrepCache)face->prep_cache;
+    FT_Memory     memory = face->root.memory;
+    FT_UInt       n;
+
+
+    if ( !cache )
+      return;
+
+    for ( n = 0; n < cache->num_entries; n++ )
+      tt_prep_snapshot_free( cache->entries + n, memory );
+
+    FT_FREE( cache );
+    face->prep_cache = NULL;
+  }
+
+
   /**************************************************************************
    *
    * @Function:
@@ -1030,15 +1298,45 @@
 
     if ( face->cvt_program_size > 0 )
     {
-      TT_Goto_CodeRange( exec, tt_coderange_cvt, 0 );
+      TT_Driver        driver   = (TT_Driver)FT_FACE_DRIVER( face );
+      TT_PrepSnapshot  snapshot = NULL;
+      FT_Bool          use_cache;
 
-      FT_TRACE4(( "Executing `prep' table.\n" ));
-      error = face->interpreter( exec );
+
+      /* Not for a debugger, which wants to step through `prep', and */
+      /* not for the Infinality interpreter with its many extra      */
+      /* execution flags.                                            */
+      use_cache = FT_BOOL( driver->prep_cache                             &&
+                           face->interpreter ==
+                             (TT_Interpreter)TT_RunIns                    &&
+                           driver->interpreter_version !=
+                             TT_INTERPRETER_VERSION_38                    );
+
+      if ( use_cache )
+        snapshot = tt_prep_cache_lookup( size, pedantic );
+
+      if ( snapshot )
+      {
+        FT_TRACE4(( "Restoring state after `prep' table.\n" ));
+        tt_prep_snapshot_restore( snapshot, size );
+        error = snapshot->error;
+      }
+      else
+      {
+        TT_Goto_CodeRange( exec, tt_coderange_cvt, 0 );
+
+        FT_TRACE4(( "Executing `prep' table.\n" ));
+        error = face->interpreter( exec );
 #ifdef FT_DEBUG_LEVEL_TRACE
-      if ( error )
-        FT_TRACE4(( "  interpretation failed with error code 0x%x\n",
-                    error ));
+        if ( error )
+          FT_TRACE4(( "  interpretation failed with error code 0x%x\n",
+                      error ));
 #endif
+
+        /* an aborted run depends on the `max-runnable-opcodes' limit */
+        if ( use_cache && FT_ERR_NEQ( error, Execution_Too_Long ) )
+          tt_prep_cache_insert( size, pedantic, error );
+      }
     }
     else
       error = FT_Err_Ok;
@@ -1331,10 +1629,54 @@
     tt_size_done_bytecode( ttsize );
 #endif
 
+    tt_size_flush_components( size );
+
     size->ttmetrics.valid = FALSE;
   }
 
 
+  /**************************************************************************
+   *
+   * @Function:
+   *   tt_size_flush_components
+   *
+   * @Description:
+   *   Discard all cached composite components of a size object.
+   *
+   * @Input:
+   *   size ::
+   *     A handle to the target size object.
+   */
+  FT_LOCAL_DEF( void )
+  tt_size_flush_components( TT_Size  size )
+  {
+    TT_ComponentCache  cache  = &size->components;
+    FT_Memory          memory = size->root.face->memory;
+    FT_UInt            n;
+
+
+    for ( n = 0; n < cache->num_entries; n++ )
+    {
+      TT_Component  entry = cache->entries + n;
+
+
+      FT_FREE( entry->points );
+      FT_FREE( entry->tags );
+      FT_FREE( entry->contours );
+    }
+
+    FT_FREE( cache->entries );
+    cache->num_entries = 0;
+    cache->max_entries = 0;
+
+    if ( cache->index_ready )
+    {
+      ft_hash_num_free( &cache->index, memory );
+      cache->index_ready = FALSE;
+    }
+  }
+
+
   /**************************************************************************
    *
    * @Function:
@@ -1440,6 +1782,9 @@
 
     size->metrics = size_metrics;
 
+    /* cached components were scaled and hinted for the old size */
+    tt_size_flush_components( size );
+
 #ifdef TT_USE_BYTECODE_INTERPRETER
     size->cvt_ready = -1;
 #endif /* TT_USE_BYTECODE_INTERPRETER */
@@ -1479,6 +1824,9 @@
     driver->interpreter_version = TT_INTERPRETER_VERSION_40;
 #endif
 
+    driver->max_runnable_opcodes = TT_CONFIG_OPTION_MAX_RUNNABLE_OPCODES;
+    driver->aborted_runs         = 0;
+
 #else /* !TT_USE_BYTECODE_INTERPRETER */
 
     FT_UNUSED( ttdriver );
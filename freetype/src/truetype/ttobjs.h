@@ -21,6 +21,7 @@
 
 
 #include <freetype/internal/ftobjs.h>
+#include <freetype/internal/fthash.h>
 #include <freetype/internal/tttypes.h>
 
 
@@ -267,6 +268,118 @@ FT_BEGIN_HEADER
   } TT_Size_Metrics;
 
 
+  /**************************************************************************
+   *
+   * A simple glyph that has been loaded as a component of a composite
+   * glyph, stored after scaling, variation, and hinting.  Together with
+   * the loader state it changes, this is everything needed to append the
+   * component to another composite without re-reading and re-hinting it.
+   */
+  typedef struct  TT_ComponentRec_
+  {
+    FT_UInt     glyph_index;
+
+    FT_Short    n_points;
+    FT_Short    n_contours;
+    FT_Vector*  points;
+    char*       tags;
+    FT_Short*   contours;
+    FT_Bool     overlap;       /* `OVERLAP_SIMPLE' was set */
+
+    FT_BBox     bbox;
+    FT_Int      left_bearing;
+    FT_Int      advance;
+    FT_Int      top_bearing;
+    FT_Int      vadvance;
+    FT_Vector   pp1, pp2, pp3, pp4;
+
+  } TT_ComponentRec, *TT_Component;
+
+
+  /**************************************************************************
+   *
+   * The per-size cache of components.  All entries are valid for a single
+   * set of load flags and interpreter version only; a change of either
+   * flushes the cache, as do a size reset and a change of the variation
+   * coordinates.  The cache is only used if the `component-cache' driver
+   * property is set.
+   */
+  typedef struct  TT_ComponentCacheRec_
+  {
+    FT_ULong      load_flags;
+    FT_UInt       interpreter_version;
+
+    FT_UInt       num_entries;
+    FT_UInt       max_entries;
+    TT_Component  entries;
+
+    FT_Bool       index_ready;
+    FT_HashRec    index;       /* glyph index -> position in `entries' */
+
+  } TT_ComponentCacheRec, *TT_ComponentCache;
+
+
+  /**************************************************************************
+   *
+   * The state of a size object after running the CVT program, together
+   * with everything the program's result depends on (the key).  Snapshots
+   * are stored in the face, so that they outlive the size objects; a size
+   * with a matching key restores the state instead of running `prep'
+   * again.  Only used if the `prep-cache' driver property is set.
+   */
+  typedef struct  TT_PrepSnapshotRec_
+  {
+    /* key */
+    FT_UShort         x_ppem;
+    FT_UShort         y_ppem;
+    FT_Fixed          x_scale;
+    FT_Fixed          y_scale;
+    FT_Long           point_size;
+    TT_Size_Metrics   ttmetrics;
+    FT_UInt           interpreter_version;
+    FT_Bool           pedantic;
+    FT_Bool           grayscale;
+    FT_Bool           subpixel_hinting_lean;
+    FT_Bool           vertical_lcd_lean;
+    FT_Bool           grayscale_cleartype;
+    FT_UInt           num_coords;
+    FT_Fixed*         coords;           /* normalized variation coords */
+
+    /* state */
+    FT_Error          error;            /* the result of `prep'        */
+    TT_GraphicsState  GS;
+    FT_Long*          cvt;
+    FT_Long*          storage;
+    FT_Vector*        twilight_org;
+    FT_Vector*        twilight_cur;
+    FT_Vector*        twilight_orus;
+    FT_Byte*          twilight_tags;
+    FT_UInt           num_function_defs;
+    FT_UInt           max_func;
+    TT_DefArray       function_defs;
+    FT_UInt           num_instruction_defs;
+    FT_UInt           max_ins;
+    TT_DefArray       instruction_defs;
+
+  } TT_PrepSnapshotRec, *TT_PrepSnapshot;
+
+
+#define TT_PREP_CACHE_SIZE  32
+
+  /**************************************************************************
+   *
+   * The per-face snapshot cache; `face->prep_cache' points to it.  If it
+   * is full, the oldest entry is replaced.
+   */
+  typedef struct  TT_PrepCacheRec_
+  {
+    FT_UInt             num_entries;
+    FT_UInt             next;          /* entry to replace next */
+    TT_PrepSnapshotRec  entries[TT_PREP_CACHE_SIZE];
+
+  } TT_PrepCacheRec, *TT_PrepCache;
+
+
   /**************************************************************************
    *
    * TrueType size class.
@@ -286,6 +399,8 @@ FT_BEGIN_HEADER
 
     FT_ULong           strike_index;      /* 0xFFFFFFFF to indicate invalid */
 
+    TT_ComponentCacheRec  components;
+
 #ifdef TT_USE_BYTECODE_INTERPRETER
 
     FT_Long            point_size;    /* for the `MPS' bytecode instruction */
@@ -335,7 +450,11 @@ FT_BEGIN_HEADER
 
     TT_GlyphZoneRec  zone;     /* glyph loader points zone */
 
-    FT_UInt  interpreter_version;
+    FT_UInt   interpreter_version;
+    FT_Bool   component_cache;
+    FT_Bool   prep_cache;
+    FT_ULong  max_runnable_opcodes;  /* per bytecode program run */
+    FT_ULong  aborted_runs;          /* runs stopped by the above limit */
 
   } TT_DriverRec;
 
@@ -394,6 +513,16 @@ FT_BEGIN_HEADER
   tt_size_reset( TT_Size  size,
                  FT_Bool  only_height );
 
+  FT_LOCAL( void )
+  tt_size_flush_components( TT_Size  size );
+
+#ifdef TT_USE_BYTECODE_INTERPRETER
+
+  FT_LOCAL( void )
+  tt_face_done_prep_cache( TT_Face  face );
+
+#endif /* TT_USE_BYTECODE_INTERPRETER */
+
 
   /**************************************************************************
    *
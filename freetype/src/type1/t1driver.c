@@ -68,16 +68,75 @@
   }
 
 
+  /* Build a hash table mapping glyph names to indices; */
+  /* the keys point into `type1->glyph_names'.          */
+  static FT_Error
+  t1_build_glyph_names_hash( T1_Face  face )
+  {
+    T1_Font    type1  = &face->type1;
+    FT_Memory  memory = face->root.memory;
+    FT_Hash    hash   = NULL;
+    FT_Int     i;
+    FT_Error   error;
+
+
+    if ( FT_QNEW( hash ) )
+      goto Exit;
+
+    error = ft_hash_str_init( hash, memory );
+    if ( error )
+      goto Fail;
+
+    for ( i = 0; i < type1->num_glyphs; i++ )
+    {
+      FT_String*  gname = type1->glyph_names[i];
+
+
+      /* like a linear search, return the first glyph with that name */
+      if ( ft_hash_str_lookup( gname, hash ) )
+        continue;
+
+      error = ft_hash_str_insert( gname, (size_t)i, hash, memory );
+      if ( error )
+        goto Fail;
+    }
+
+    type1->glyph_names_hash = hash;
+
+  Exit:
+    return error;
+
+  Fail:
+    ft_hash_str_free( hash, memory );
+    FT_FREE( hash );
+    goto Exit;
+  }
+
+
   static FT_UInt
   t1_get_name_index( T1_Face           face,
                      const FT_String*  glyph_name )
   {
-    FT_Int  i;
+    T1_Font  type1 = &face->type1;
+    FT_Int   i;
+
 
+    if ( !type1->glyph_names_hash )
+      (void)t1_build_glyph_names_hash( face );
+
+    if ( type1->glyph_names_hash )
+    {
+      size_t*  gindex = ft_hash_str_lookup( glyph_name,
+                                            type1->glyph_names_hash );
+
+
+      return gindex ? (FT_UInt)*gindex : 0;
+    }
 
-    for ( i = 0; i < face->type1.num_glyphs; i++ )
+    /* out of memory; fall back to a linear search */
+    for ( i = 0; i < type1->num_glyphs; i++ )
     {
-      FT_String*  gname = face->type1.glyph_names[i];
+      FT_String*  gname = type1->glyph_names[i];
 
 
       if ( !ft_strcmp( glyph_name, gname ) )
@@ -254,6 +254,9 @@
     ft_hash_num_free( type1->subrs_hash, memory );
     FT_FREE( type1->subrs_hash );
 
+    ft_hash_str_free( type1->glyph_names_hash, memory );
+    FT_FREE( type1->glyph_names_hash );
+
     FT_FREE( type1->subrs_block );
     FT_FREE( type1->charstrings_block );
     FT_FREE( type1->glyph_names_block );
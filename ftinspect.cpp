@@ -6,6 +6,10 @@
 
 #include "maingui.hpp"
 #include "engine/engine.hpp"
+#include "engine/renderservice.hpp"
+#include "engine/renderworker.hpp"
+
+#include <cstring>
 
 #include <QApplication>
 
@@ -16,6 +20,45 @@ int
 main(int argc,
      char** argv)
 {
+  // Crash-isolated rendering runs in child processes of ftinspect itself;
+  // they don't need a GUI.
+  if (argc > 1 && !std::strcmp(argv[1], RenderWorkerPool::WorkerArgument))
+    return RenderWorkerPool::runWorker();
+
+  // Headless render service; see `RenderService`.
+  if (argc > 2 && !std::strcmp(argv[1], RenderService::ServeArgument))
+  {
+    QCoreApplication app(argc, argv);
+    Engine engine;
+    RenderService service(NULL, &engine);
+    if (!service.listen(QString::fromLocal8Bit(argv[2])))
+    {
+      qCritical("ftinspect: can't listen on `%s': %s",
+                argv[2], qPrintable(service.errorString()));
+      return 1;
+    }
+    return app.exec();
+  }
+
+  // Replay a recorded session and quit; the remaining arguments are left
+  // to Qt (e.g., `-platform offscreen` to run without a display).
+  QString replayTrace;
+  QString replayReport;
+  if (argc > 2 && !std::strcmp(argv[1], SessionRecorder::ReplayArgument))
+  {
+    replayTrace = QString::fromLocal8Bit(argv[2]);
+    auto consumed = 2;
+    if (argc > 3 && argv[3][0] != '-')
+    {
+      replayReport = QString::fromLocal8Bit(argv[3]);
+      consumed = 3;
+    }
+    for (int i = 1; i + consumed < argc; i++)
+      argv[i] = argv[i + consumed];
+    argc -= consumed;
+    argv[argc] = NULL;
+  }
+
   auto version = QString("%1.%2.%3")
                    .arg(QString::number(FREETYPE_MAJOR),
                         QString::number(FREETYPE_MINOR),
@@ -31,6 +74,8 @@ main(int argc,
   MainGUI gui(&engine);
 
   gui.show();
+  if (!replayTrace.isEmpty())
+    return gui.replaySessionHeadless(replayTrace, replayReport) ? 0 : 1;
 
   return app.exec();
 }
@@ -4,7 +4,11 @@
 // Charlie Jiang.
 
 #include "../engine/engine.hpp"
+#include "../engine/glyphtimer.hpp"
 #include "glyphcontinuous.hpp"
+#include "glyphoutline.hpp"
+
+#include <cmath>
 
 #include <QPainter>
 #include <QWheelEvent>
@@ -12,37 +16,6 @@
 #include <freetype/ftbitmap.h>
 
 
-GlyphCacheEntry::~GlyphCacheEntry()
-{
-  delete image;
-}
-
-
-GlyphCacheEntry::GlyphCacheEntry(GlyphCacheEntry&& other) noexcept
-{
-  *this = std::move(other);
-}
-
-
-GlyphCacheEntry&
-GlyphCacheEntry::operator=(GlyphCacheEntry&& other) noexcept
-{
-  if (this == &other)
-    return *this;
-
-  auto oldImage = image;
-  image = other.image;
-  basePosition = other.basePosition;
-  penPos = other.penPos;
-  charCode = other.charCode;
-  glyphIndex = other.glyphIndex;
-  nonSpacingPlaceholder = other.nonSpacingPlaceholder;
-  advance = other.advance;
-  other.image = oldImage;
-  return *this;
-}
-
-
 GlyphContinuous::GlyphContinuous(QWidget* parent,
                                  Engine* engine)
 : QWidget(parent),
@@ -96,6 +69,15 @@ GlyphContinuous::setSourceText(QString text)
 }
 
 
+void
+GlyphContinuous::updateSourceText(QString text)
+{
+  text_ = std::move(text);
+  stringRenderer_.updateString(text_);
+  clearLines(); // The pooled glyph images stay valid.
+}
+
+
 void
 GlyphContinuous::flashOnGlyph(int glyphIndex)
 {
@@ -118,9 +100,41 @@ GlyphContinuous::stopFlashing()
 void
 GlyphContinuous::purgeCache()
 {
-  glyphCache_.clear();
+  clearLines();
+  imagePool_.clear();
   backgroundColorCache_ = engine_->renderingEngine()->background();
+}
+
+
+void
+GlyphContinuous::clearLines()
+{
+  glyphCache_.clear();
   currentWritingLine_ = NULL;
+  clippedImagesInCache_ = false;
+}
+
+
+bool
+GlyphContinuous::retintCache()
+{
+  // The pool holds every cached image exactly once.
+  auto renderingEngine = engine_->renderingEngine();
+  for (auto& pooled : imagePool_)
+    if (pooled.second.image
+        && !renderingEngine->retintImage(pooled.second.image.get()))
+    {
+      purgeCache();
+      return false;
+    }
+
+  // Clipped images are not in the pool; they are small enough to be
+  // rendered again.  Paths are filled with the current colors anyway.
+  if (clippedImagesInCache_)
+    clearLines();
+
+  backgroundColorCache_ = renderingEngine->background();
+  return true;
 }
 
 
@@ -161,7 +175,7 @@ GlyphContinuous::wheelEvent(QWheelEvent* event)
 void
 GlyphContinuous::resizeEvent(QResizeEvent* event)
 {
-  purgeCache();
+  clearLines(); // The glyph images stay the same.
   QWidget::resizeEvent(event);
 }
 
@@ -217,7 +231,7 @@ GlyphContinuous::mouseMoveEvent(QMouseEvent* event)
     horiPos = qBound(0.0, horiPos, 1.0);
     stringRenderer_.setPosition(horiPos);
 
-    purgeCache();
+    clearLines();
     repaint();
   }
 }
@@ -251,9 +265,13 @@ GlyphContinuous::mouseReleaseEvent(QMouseEvent* event)
 void
 GlyphContinuous::paintByRenderer()
 {
-  purgeCache();
+  clearLines();
+  if (imagePool_.size() > MaxPooledImages)
+    imagePool_.clear();
 
   stringRenderer_.setRepeated(source_ == SRC_TextStringRepeated);
+  // The small bitmap cache holds unmodified glyphs only.
+  stringRenderer_.setUseSBitCache(mode_ == M_Normal);
   stringRenderer_.setCallback(
     [&](FT_Glyph glyph,
         FT_Vector penPos,
@@ -275,6 +293,12 @@ GlyphContinuous::paintByRenderer()
     {
       preprocessGlyph(ptr);
     });
+  stringRenderer_.setCachedGlyphCallback(
+    [&](FT_Vector penPos,
+        GlyphContext& ctx)
+    {
+      return saveCachedGlyph(penPos, ctx);
+    });
   stringRenderer_.setLineBeginCallback(
     [&](FT_Vector pos,
         double size)
@@ -365,11 +389,20 @@ GlyphContinuous::paintCache(QPainter* painter)
 
   if (stringRenderer_.isWaterfall())
     positionDelta_.setY(0);
+
+  // Waterfall lines use different sizes, so one measurement can't apply.
+  auto heatmap = heatmapTimer_
+                 && source_ == SRC_AllGlyphs
+                 && !stringRenderer_.isWaterfall()
+                 && heatmapTimer_->referenceTime() > 0
+                 && heatmapTimer_->matches(engine_);
   for (auto& line : glyphCache_)
   {
     beginDrawCacheLine(painter, line);
     for (auto& glyph : line.entries)
     {
+      if (heatmap)
+        drawHeatmapCell(painter, line, glyph);
       if (glyph.glyphIndex == flashGlyphIndex_ && flashFlipFlop)
         drawCacheGlyph(painter, glyph, true);
       else
@@ -379,6 +412,33 @@ GlyphContinuous::paintCache(QPainter* painter)
 }
 
 
+QRect
+GlyphContinuous::visibleCacheArea()
+{
+  // See `paintCache` and `drawCacheGlyph` for the offsets applied when
+  // drawing.
+  auto delta = positionDelta_;
+  if (stringRenderer_.isWaterfall())
+    delta.setY(0);
+
+  QRect area(-delta,
+             QSize(static_cast<int>(std::ceil(width() / scale_)),
+                   static_cast<int>(std::ceil(height() / scale_))));
+
+  // Waterfall lines are moved to the right by the size indicator, which is
+  // only known while drawing; a line showing anything at all has it
+  // narrower than the canvas.  Glyphs without advance width are moved to
+  // the right of their placeholder square.
+  if (stringRenderer_.isWaterfall())
+    area.setLeft(area.left() - area.width());
+  if (currentWritingLine_)
+    area.setLeft(area.left()
+                 - static_cast<int>(currentWritingLine_
+                                      ->nonSpacingPlaceholder));
+  return area;
+}
+
+
 void
 GlyphContinuous::fillCache()
 {
@@ -471,6 +531,9 @@ GlyphContinuous::beginSaveLine(FT_Vector pos,
   currentWritingLine_->nonSpacingPlaceholder
     = engine_->currentFontMetrics().y_ppem / 2;
   currentWritingLine_->sizePoint = sizePoint;
+  auto ascDesc = engine_->currentSizeAscDescPx();
+  currentWritingLine_->ascender = ascDesc.first;
+  currentWritingLine_->descender = ascDesc.second;
   currentWritingLine_->basePosition = { static_cast<int>(pos.x),
                                         static_cast<int>(pos.y) };
 }
@@ -485,6 +548,43 @@ GlyphContinuous::saveSingleGlyph(FT_Glyph glyph,
     return;
 
   QRect rect;
+  if (glyph->format == FT_GLYPH_FORMAT_OUTLINE)
+  {
+    FT_BBox cbox;
+    FT_Glyph_Get_CBox(glyph, FT_GLYPH_BBOX_PIXELS, &cbox);
+    if (cbox.xMax - cbox.xMin > VectorDrawingThreshold
+        || cbox.yMax - cbox.yMin > VectorDrawingThreshold)
+    {
+      saveSingleGlyphPath(glyph, penPos, gctx);
+      return;
+    }
+
+    // Don't rasterize (and allocate) more than what is visible.
+    auto clip = visibleCacheArea().translated(-static_cast<int>(penPos.x),
+                                              -static_cast<int>(penPos.y));
+    QRect glyphRect(static_cast<int>(cbox.xMin),
+                    static_cast<int>(-cbox.yMax),
+                    static_cast<int>(cbox.xMax - cbox.xMin),
+                    static_cast<int>(cbox.yMax - cbox.yMin));
+    // The LCD filter can't be clipped; below the vector drawing threshold
+    // such glyphs are rasterized in full.
+    auto mode = engine_->renderMode();
+    auto clippable = mode != FT_RENDER_MODE_LCD
+                     && mode != FT_RENDER_MODE_LCD_V;
+    if (clippable && !clip.contains(glyphRect))
+    {
+      auto image = engine_->renderingEngine()
+                     ->convertGlyphToQImageClipped(glyph, clip, &rect);
+      PooledGlyphImage clipped = { std::shared_ptr<QImage>(image),
+                                   rect,
+                                   glyph->advance,
+                                   NULL };
+      saveEntry(clipped, penPos, glyph->advance, gctx);
+      clippedImagesInCache_ = true;
+      return;
+    }
+  }
+
   QImage* image = engine_->renderingEngine()->convertGlyphToQImage(glyph,
                                                                    &rect,
                                                                    true);
@@ -492,6 +592,24 @@ GlyphContinuous::saveSingleGlyph(FT_Glyph glyph,
 }
 
 
+void
+GlyphContinuous::saveSingleGlyphPath(FT_Glyph glyph,
+                                     FT_Vector penPos,
+                                     GlyphContext& gctx)
+{
+  auto outline = &reinterpret_cast<FT_OutlineGlyph>(glyph)->outline;
+  auto path = std::make_shared<QPainterPath>(outlineToPath(outline));
+
+  // Unlike clipped images, paths don't depend on the position.
+  PooledGlyphImage pooled = { NULL,
+                              path->boundingRect().toAlignedRect(),
+                              glyph->advance,
+                              path };
+  imagePool_.emplace(imageKey(gctx), pooled);
+  saveEntry(pooled, penPos, glyph->advance, gctx);
+}
+
+
 void
 GlyphContinuous::saveSingleGlyphImage(QImage* image,
                                       QRect rect,
@@ -500,18 +618,69 @@ GlyphContinuous::saveSingleGlyphImage(QImage* image,
                                       GlyphContext gctx)
 {
   if (!currentWritingLine_)
+  {
+    delete image;
+    return;
+  }
+
+  // Direct images (color layers, small bitmaps) are created by the renderer
+  // for every occurrence; keep only the first one.
+  auto key = imageKey(gctx);
+  auto it = imagePool_.find(key);
+  if (it != imagePool_.end())
+  {
+    delete image;
+    saveEntry(it->second, penPos, advance, gctx);
     return;
+  }
+
+  PooledGlyphImage pooled = { std::shared_ptr<QImage>(image), rect, advance };
+  if (image)
+    imagePool_.emplace(key, pooled);
+  saveEntry(pooled, penPos, advance, gctx);
+}
+
+
+bool
+GlyphContinuous::saveCachedGlyph(FT_Vector penPos,
+                                 GlyphContext& gctx)
+{
+  if (!currentWritingLine_)
+    return false;
+
+  auto it = imagePool_.find(imageKey(gctx));
+  if (it == imagePool_.end())
+    return false;
+
+  saveEntry(it->second, penPos, it->second.advance, gctx);
+  return true;
+}
 
+
+GlyphContinuous::GlyphImageKey
+GlyphContinuous::imageKey(GlyphContext& gctx)
+{
+  return GlyphImageKey(gctx.fallbackFontIndex,
+                       gctx.glyphIndex,
+                       currentWritingLine_->sizePoint);
+}
+
+
+void
+GlyphContinuous::saveEntry(PooledGlyphImage const& pooled,
+                           FT_Vector penPos,
+                           FT_Vector advance,
+                           GlyphContext& gctx)
+{
   currentWritingLine_->entries.emplace_back();
   auto& entry = currentWritingLine_->entries.back();
 
   QPoint penPosPoint = { static_cast<int>(penPos.x),
                          static_cast<int>(penPos.y) };
 
-  rect.translate(penPosPoint);
-
-  entry.image = image;
-  entry.basePosition = rect;
+  entry.image = pooled.image;
+  entry.path = pooled.path;
+  entry.basePosition = pooled.rect.translated(penPosPoint);
   entry.charCode = gctx.charCode;
   entry.glyphIndex = gctx.glyphIndex;
   entry.advance = advance;
@@ -570,6 +739,29 @@ GlyphContinuous::drawCacheGlyph(QPainter* painter,
     xOffset = width; // Let the glyph be drawn on the red square.
   }
 
+  if (entry.path)
+  {
+    auto foreground = engine_->renderingEngine()->foreground();
+    if (colorInverted)
+      foreground = qRgba(255 - qRed(foreground),
+                         255 - qGreen(foreground),
+                         255 - qBlue(foreground),
+                         qAlpha(foreground));
+
+    painter->save();
+    painter->setRenderHint(QPainter::Antialiasing,
+                           engine_->antiAliasingEnabled());
+    painter->translate(entry.penPos
+                       + QPoint(sizeIndicatorOffset_ + xOffset, 0)
+                       + positionDelta_);
+    painter->fillPath(*entry.path, QColor::fromRgba(foreground));
+    painter->restore();
+    return;
+  }
+
+  if (!entry.image)
+    return;
+
   QRect rect = entry.basePosition;
   rect.moveLeft(rect.x() + sizeIndicatorOffset_ + xOffset);
   rect.translate(positionDelta_);
@@ -585,6 +777,35 @@ GlyphContinuous::drawCacheGlyph(QPainter* painter,
 }
 
 
+void
+GlyphContinuous::drawHeatmapCell(QPainter* painter,
+                                 const GlyphCacheLine& line,
+                                 const GlyphCacheEntry& entry)
+{
+  auto& times = heatmapTimer_->times();
+  if (entry.glyphIndex < 0
+      || static_cast<size_t>(entry.glyphIndex) >= times.size())
+    return;
+
+  auto time = times[entry.glyphIndex];
+  if (time < 0)
+    return; // Not measured yet, or failed to load.
+
+  // Map the cost on a logarithmic scale relative to the median: Typical
+  // glyphs get a faint green, outliers an opaque red.
+  auto ratio = static_cast<double>(time) / heatmapTimer_->referenceTime();
+  auto t = qBound(0.0, std::log2(ratio) / HeatmapMaxRatioLog2, 1.0);
+  auto color = QColor::fromHsvF((1.0 - t) / 3.0, 1.0, 1.0, 0.15 + 0.5 * t);
+
+  int width = entry.advance.x ? entry.advance.x >> 16
+                              : entry.nonSpacingPlaceholder;
+  auto rect = QRect(entry.penPos.x(), entry.penPos.y() - line.ascender,
+                    width, line.ascender - line.descender);
+  rect.translate(positionDelta_);
+  painter->fillRect(rect, color);
+}
+
+
 GlyphCacheEntry*
 GlyphContinuous::findGlyphByMouse(QPoint position,
                                   double* outSizePoint)
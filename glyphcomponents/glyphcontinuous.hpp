@@ -8,10 +8,14 @@
 #include "../engine/stringrenderer.hpp"
 #include "graphicsdefault.hpp"
 
+#include <map>
+#include <memory>
+#include <tuple>
 #include <utility>
 #include <vector>
 
 #include <QImage>
+#include <QPainterPath>
 #include <QTimer>
 #include <QWidget>
 
@@ -22,10 +26,13 @@
 
 
 // We store images in the cache so we don't need to render all glyphs every time
-// when repainting the widget.
+// when repainting the widget.  Entries showing the same glyph (e.g., in
+// repeated strings) share the image.  Glyphs too large to be rasterized are
+// stored as paths instead; either may be NULL if nothing is visible.
 struct GlyphCacheEntry
 {
-  QImage* image = NULL;
+  std::shared_ptr<QImage> image;
+  std::shared_ptr<QPainterPath> path;
   QRect basePosition = {};
   QPoint penPos = {};
   int charCode = -1;
@@ -33,13 +40,6 @@ struct GlyphCacheEntry
   unsigned nonSpacingPlaceholder = 0;
 
   FT_Vector advance = {};
-
-  GlyphCacheEntry() {}
-  ~GlyphCacheEntry();
-  GlyphCacheEntry(const GlyphCacheEntry& other) = delete;
-  GlyphCacheEntry& operator=(const GlyphCacheEntry& other) = delete;
-  GlyphCacheEntry(GlyphCacheEntry&& other) noexcept;
-  GlyphCacheEntry& operator=(GlyphCacheEntry&& other) noexcept;
 };
 
 
@@ -49,11 +49,14 @@ struct GlyphCacheLine
   double sizePoint = 0.0;
   int sizeIndicatorOffset;
   unsigned short nonSpacingPlaceholder;
+  int ascender = 0; // In pixels; for the heatmap cells.
+  int descender = 0;
   std::vector<GlyphCacheEntry> entries;
 };
 
 
 class Engine;
+class GlyphTimer;
 
 class GlyphContinuous
 : public QWidget
@@ -96,12 +99,22 @@ public:
   }
   void setStrokeRadius(double radius) { strokeRadius_ = radius; }
   void setSourceText(QString text);
+  // Keep the glyphs of unchanged characters; only valid if no other
+  // setting changed since the last paint (see `StringRenderer`).
+  void updateSourceText(QString text);
   void setMouseOperationEnabled(bool enabled)
          { mouseOperationEnabled_ = enabled; }
+  // Tint glyphs by their load time when showing all glyphs; NULL disables
+  // the heatmap.  The timer's results are only used if they match the
+  // current font and settings.
+  void setHeatmap(GlyphTimer* timer) { heatmapTimer_ = timer; }
 
   void flashOnGlyph(int glyphIndex);
   void stopFlashing();
   void purgeCache();
+  // Apply changed colors or gamma to the cached images.  If some image can't
+  // be retinted, the cache is purged and `false` is returned.
+  bool retintCache();
   void resetPositionDelta();
 
 signals:
@@ -149,8 +162,27 @@ private:
   FT_Matrix shearMatrix_;
 
   FT_Stroker stroker_;
+  GlyphTimer* heatmapTimer_ = NULL;
 
   std::vector<GlyphCacheLine> glyphCache_;
+
+  // All images referenced by `glyphCache_`, keyed by (fallback font index,
+  // glyph index, size in points).  All other settings are the same for the
+  // whole pool since it is dropped by `purgeCache`; this way, the pool
+  // survives refilling the cache after moving the text or resizing.
+  using GlyphImageKey = std::tuple<int, int, double>;
+  struct PooledGlyphImage
+  {
+    std::shared_ptr<QImage> image;
+    QRect rect; // Relative to the pen position.
+    FT_Vector advance; // Of the preprocessed glyph.
+    std::shared_ptr<QPainterPath> path;
+  };
+  std::map<GlyphImageKey, PooledGlyphImage> imagePool_;
+  // Images of glyphs exceeding the canvas only cover the visible part;
+  // they depend on the position, so they are never pooled.
+  bool clippedImagesInCache_ = false;
+
   QColor backgroundColorCache_;
   GlyphCacheLine* currentWritingLine_ = NULL;
 
@@ -163,6 +195,7 @@ private:
   int averageLineCount_ = 0;
 
   void paintByRenderer();
+  void clearLines();
 
   // These two assume functions ownership of glyphs, but don't free them.
   // However, remember to free the glyph returned from
@@ -171,6 +204,8 @@ private:
   FT_Glyph transformGlyphStroked(FT_Glyph glyph);
 
   void paintCache(QPainter* painter);
+  // The canvas in the coordinates of `glyphCache_`.
+  QRect visibleCacheArea();
   void fillCache();
   void prePaint();
   void updateStroke();
@@ -188,6 +223,16 @@ private:
                             FT_Vector penPos,
                             FT_Vector advance,
                             GlyphContext gctx);
+  void saveSingleGlyphPath(FT_Glyph glyph,
+                           FT_Vector penPos,
+                           GlyphContext& gctx);
+  bool saveCachedGlyph(FT_Vector penPos,
+                       GlyphContext& gctx);
+  GlyphImageKey imageKey(GlyphContext& gctx);
+  void saveEntry(PooledGlyphImage const& pooled,
+                 FT_Vector penPos,
+                 FT_Vector advance,
+                 GlyphContext& gctx);
 
   // Functions drawing from the cache.
   void beginDrawCacheLine(QPainter* painter,
@@ -195,6 +240,9 @@ private:
   void drawCacheGlyph(QPainter* painter,
                       const GlyphCacheEntry& entry,
                       bool colorInverted = false);
+  void drawHeatmapCell(QPainter* painter,
+                       const GlyphCacheLine& line,
+                       const GlyphCacheEntry& entry);
 
   // Mouse operations.
   GlyphCacheEntry* findGlyphByMouse(QPoint position,
@@ -211,6 +259,19 @@ private:
   // Flash timer constants.
   constexpr static int FlashIntervalMs = 250;
   constexpr static int FlashDurationMs = 3000;
+
+  // The image pool is reset before refilling the cache if it grew larger.
+  constexpr static size_t MaxPooledImages = 4096;
+
+  // Outline glyphs larger than this (in pixels) are filled as paths instead
+  // of being rasterized, even if clipped to the canvas: at these sizes
+  // there is no visible difference, and the rasterizers' cost still
+  // grows with the outline.
+  constexpr static int VectorDrawingThreshold = 4096;
+
+  // Heatmap constants: glyphs taking this many times the median load time
+  // (or more) are shown in full red.
+  constexpr static double HeatmapMaxRatioLog2 = 4;
 };
 
 
@@ -88,6 +88,19 @@ static FT_Outline_Funcs outlineFuncs =
 } // extern "C"
 
 
+QPainterPath
+outlineToPath(FT_Outline* outline)
+{
+  QPainterPath path;
+  FT_Outline_Decompose(outline, &outlineFuncs, &path);
+  // Qt defaults to the even-odd rule; overlapping contours need FreeType's.
+  path.setFillRule((outline->flags & FT_OUTLINE_EVEN_ODD_FILL)
+                     ? Qt::OddEvenFill
+                     : Qt::WindingFill);
+  return path;
+}
+
+
 GlyphOutline::GlyphOutline(const QPen& pen,
                            FT_Glyph glyph)
 : outlinePen_(pen)
@@ -95,7 +108,7 @@ GlyphOutline::GlyphOutline(const QPen& pen,
   if (glyph->format != FT_GLYPH_FORMAT_OUTLINE)
     return;
   auto outline = &reinterpret_cast<FT_OutlineGlyph>(glyph)->outline;
-  FT_Outline_Decompose(outline, &outlineFuncs, &path_);
+  path_ = outlineToPath(outline);
 
   FT_BBox cbox;
 
@@ -16,6 +16,11 @@
 #include <freetype/ftoutln.h>
 
 
+// Convert an outline to a path with Qt's orientation (y axis pointing
+// down), in pixels, using the outline's fill rule.
+QPainterPath outlineToPath(FT_Outline* outline);
+
+
 class GlyphOutline
 : public QGraphicsItem
 {
@@ -0,0 +1,128 @@
+// ppemstrip.cpp
+
+// Copyright (C) 2022-2023 by
+// Charlie Jiang.
+
+#include "ppemstrip.hpp"
+
+#include <algorithm>
+
+#include <QMouseEvent>
+#include <QPainter>
+
+
+PpemStrip::PpemStrip(QWidget* parent)
+: QWidget(parent)
+{
+  setToolTip(tr("Click on a size to show it in the grid view."));
+}
+
+
+void
+PpemStrip::setImages(std::vector<PpemSweepImage> const& images)
+{
+  images_ = images; // The images themselves are shared.
+  updateLayout();
+  update();
+}
+
+
+void
+PpemStrip::setCurrentPpem(int ppem)
+{
+  if (currentPpem_ == ppem)
+    return;
+  currentPpem_ = ppem;
+  update();
+}
+
+
+void
+PpemStrip::setBackground(QColor color)
+{
+  background_ = color;
+  update();
+}
+
+
+void
+PpemStrip::paintEvent(QPaintEvent* event)
+{
+  QPainter painter(this);
+  painter.fillRect(rect(), background_);
+
+  auto labelHeight = fontMetrics().height();
+  int left = 0;
+  for (size_t i = 0; i < images_.size(); i++)
+  {
+    auto& entry = images_[i];
+    auto cellRect = QRect(left, 0, cellRight_[i] - left, height());
+    left = cellRight_[i];
+    if (!cellRect.intersects(event->rect()))
+      continue;
+
+    if (entry.ppem == currentPpem_)
+    {
+      painter.setPen(palette().color(QPalette::Highlight));
+      painter.drawRect(cellRect.adjusted(0, 0, -1, -1));
+    }
+
+    if (!entry.image.isNull())
+      painter.drawImage(
+        cellRect.left() + (cellRect.width() - entry.image.width()) / 2,
+        baseline_ - entry.top,
+        entry.image);
+
+    painter.setPen(Qt::gray);
+    painter.drawText(QRect(cellRect.left(), labelTop_,
+                           cellRect.width(), labelHeight),
+                     Qt::AlignCenter, QString::number(entry.ppem));
+  }
+}
+
+
+void
+PpemStrip::mouseReleaseEvent(QMouseEvent* event)
+{
+  if (event->button() != Qt::LeftButton)
+    return;
+
+  auto it = std::upper_bound(cellRight_.begin(), cellRight_.end(),
+                             event->pos().x());
+  if (it == cellRight_.end())
+    return;
+  emit ppemClicked(images_[it - cellRight_.begin()].ppem);
+}
+
+
+void
+PpemStrip::updateLayout()
+{
+  int ascent = 0;
+  int descent = 0;
+  for (auto& entry : images_)
+  {
+    if (entry.image.isNull())
+      continue;
+    ascent = std::max(ascent, entry.top);
+    descent = std::max(descent, entry.image.height() - entry.top);
+  }
+
+  baseline_ = CellMargin + ascent;
+  labelTop_ = baseline_ + descent + CellMargin;
+
+  cellRight_.clear();
+  int right = 0;
+  for (auto& entry : images_)
+  {
+    auto labelWidth
+      = fontMetrics().horizontalAdvance(QString::number(entry.ppem));
+    right += std::max(entry.image.width(), labelWidth) + 2 * CellMargin;
+    cellRight_.push_back(right);
+  }
+
+  setFixedSize(right, labelTop_ + fontMetrics().height() + CellMargin);
+}
+
+
+// end of ppemstrip.cpp
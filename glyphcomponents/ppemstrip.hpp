@@ -0,0 +1,53 @@
+// ppemstrip.hpp
+
+// Copyright (C) 2022-2023 by
+// Charlie Jiang.
+
+#pragma once
+
+#include "../engine/ppemsweep.hpp"
+
+#include <vector>
+
+#include <QColor>
+#include <QWidget>
+
+
+// A row of glyph images rendered at increasing ppem values, aligned on a
+// common baseline and labeled with their ppem.  Meant to be put into a
+// scroll area.
+class PpemStrip
+: public QWidget
+{
+  Q_OBJECT
+
+public:
+  PpemStrip(QWidget* parent);
+  ~PpemStrip() override = default;
+
+  void setImages(std::vector<PpemSweepImage> const& images);
+  void setCurrentPpem(int ppem);
+  void setBackground(QColor color);
+
+signals:
+  void ppemClicked(int ppem);
+
+protected:
+  void paintEvent(QPaintEvent* event) override;
+  void mouseReleaseEvent(QMouseEvent* event) override;
+
+private:
+  constexpr static int CellMargin = 4;
+
+  std::vector<PpemSweepImage> images_;
+  std::vector<int> cellRight_; // Right edge of each cell.
+  int baseline_ = 0;
+  int labelTop_ = 0;
+  int currentPpem_ = 0;
+  QColor background_ = Qt::white;
+
+  void updateLayout();
+};
+
+
+// end of ppemstrip.hpp
@@ -5,16 +5,19 @@
 
 
 #include "maingui.hpp"
+#include "engine/profiler.hpp"
 
 #include <QApplication>
 #include <QDragEnterEvent>
 #include <QDropEvent>
+#include <QFile>
 #include <QFileDialog>
 #include <QMessageBox>
 #include <QMimeData>
 #include <QScrollBar>
 #include <QSettings>
 #include <QStatusBar>
+#include <QTextStream>
 
 
 MainGUI::MainGUI(Engine* engine)
@@ -98,6 +101,8 @@ MainGUI::about()
   auto dynamicVersion = engine_->dynamicLibraryVersion();
   if (version != dynamicVersion)
     version = QString("%1 (library ver. %2)").arg(version, dynamicVersion);
+  auto& stats = engine_->reloadStatistics();
+  auto reloads = stats.reloads + stats.skippedReloads;
   QMessageBox::about(
     this,
     tr("About ftinspect"),
@@ -114,9 +119,13 @@ all rendering parameters.</p>
 <a href='https://gitlab.freedesktop.org/freetype/freetype/-/blob/master/docs/FTL.TXT'>FreeType
 License (FTL)</a> or
 <a href='https://gitlab.freedesktop.org/freetype/freetype/-/blob/master/docs/GPLv2.TXT'>GNU
-GPLv2</a></p>)")
+GPLv2</a></p>
+
+<p><small>Font reloads skipped in this session: %3 of %4</small></p>)")
           .arg(version)
-       .arg(QChar(0xA9)));
+       .arg(QChar(0xA9))
+       .arg(stats.skippedReloads)
+       .arg(reloads));
 }
 
 
@@ -144,6 +153,7 @@ MainGUI::loadFonts()
 void
 MainGUI::openFonts(QStringList const& fileNames)
 {
+  sessionRecorder_->recordFontsOpened(fileNames);
   engine_->openFonts(fileNames);
   tripletSelector_->repopulateFonts();
 }
@@ -233,6 +243,14 @@ MainGUI::repaintCurrentTab()
 }
 
 
+void
+MainGUI::recolorCurrentTab()
+{
+  applySettings();
+  tabs_[tabWidget_->currentIndex()]->recolorGlyph();
+}
+
+
 void
 MainGUI::reloadCurrentTabFont()
 {
@@ -284,6 +302,7 @@ MainGUI::createLayout()
                                      glyphDetailsDockWidget_, glyphDetails_);
   comparatorTab_ = new ComparatorTab(this, engine_);
   infoTab_ = new InfoTab(this, engine_);
+  fontWallTab_ = new FontWallTab(this, engine_);
 
   tabWidget_ = new QTabWidget(this);
   tabWidget_->setObjectName("mainTab"); // for stylesheet
@@ -297,6 +316,8 @@ MainGUI::createLayout()
   tabWidget_->addTab(comparatorTab_, tr("Comparator View"));
   tabs_.push_back(infoTab_);
   tabWidget_->addTab(infoTab_, tr("Font Info"));
+  tabs_.push_back(fontWallTab_);
+  tabWidget_->addTab(fontWallTab_, tr("Font Wall"));
   lastTab_ = singularTab_;
 
   tabWidget_->setTabToolTip(0, tr(
@@ -310,6 +331,8 @@ MainGUI::createLayout()
     " (e.g., hintings)."));
   tabWidget_->setTabToolTip(3, tr(
     "View font info and metadata."));
+  tabWidget_->setTabToolTip(4, tr(
+    "View a sample string in all faces of all opened fonts at once."));
 
   tripletSelector_ = new TripletSelector(this, engine_);
 
@@ -354,6 +377,8 @@ MainGUI::createConnections()
           this, &MainGUI::reloadCurrentTabFont);
   connect(settingPanel_, &SettingPanel::repaintNeeded,
           this, &MainGUI::repaintCurrentTab);
+  connect(settingPanel_, &SettingPanel::recolorNeeded,
+          this, &MainGUI::recolorCurrentTab);
 
   connect(tabWidget_, &QTabWidget::currentChanged,
           this, &MainGUI::switchTab);
@@ -378,9 +403,157 @@ MainGUI::createConnections()
 }
 
 
+void
+MainGUI::toggleProfiler(bool enabled)
+{
+  if (enabled)
+  {
+    if (!SamplingProfiler::start())
+    {
+      QMessageBox::warning(this, tr("Sampling Profiler"),
+                           tr("Can't start the profiler."));
+      QSignalBlocker blocker(profilerAct_);
+      profilerAct_->setChecked(false);
+    }
+    return;
+  }
+
+  SamplingProfiler::stop();
+
+  auto samples = SamplingProfiler::sampleCount();
+  auto fileName = QFileDialog::getSaveFileName(
+                    this,
+                    tr("Save folded stacks (%n sample(s))", "", samples),
+                    QDir::homePath() + "/ftinspect.folded",
+                    tr("Folded stacks (*.folded);;All files (*)"));
+  if (fileName.isEmpty())
+    return;
+
+  if (!SamplingProfiler::writeFoldedStacks(fileName))
+    QMessageBox::warning(this, tr("Sampling Profiler"),
+                         tr("Can't write `%1'.").arg(fileName));
+  else if (SamplingProfiler::droppedSampleCount() > 0)
+    QMessageBox::information(
+      this, tr("Sampling Profiler"),
+      tr("The sample buffer was full; %n later sample(s) were dropped.", "",
+         SamplingProfiler::droppedSampleCount()));
+}
+
+
+void
+MainGUI::toggleSessionRecording(bool enabled)
+{
+  if (enabled)
+  {
+    QStringList openFonts;
+    auto& manager = engine_->fontFileManager();
+    for (int i = 0; i < manager.size(); i++)
+      openFonts.append(manager[i].absoluteFilePath());
+    sessionRecorder_->start(openFonts);
+    return;
+  }
+
+  sessionRecorder_->stop();
+  auto fileName = QFileDialog::getSaveFileName(
+                    this,
+                    tr("Save session trace"),
+                    QDir::homePath() + "/ftinspect-session.json",
+                    tr("Session traces (*.json);;All files (*)"));
+  if (!fileName.isEmpty() && !sessionRecorder_->save(fileName))
+    QMessageBox::warning(this, tr("Record Session"),
+                         tr("Can't write `%1'.").arg(fileName));
+}
+
+
+void
+MainGUI::replaySession()
+{
+  auto fileName = QFileDialog::getOpenFileName(
+                    this,
+                    tr("Replay session trace"),
+                    QDir::homePath(),
+                    tr("Session traces (*.json);;All files (*)"));
+  if (fileName.isEmpty())
+    return;
+
+  QString error;
+  auto results = sessionRecorder_->replay(fileName, error);
+  if (results.empty())
+  {
+    QMessageBox::warning(this, tr("Replay Session"),
+                         tr("Can't replay `%1':\n%2").arg(fileName, error));
+    return;
+  }
+
+  QMessageBox box(QMessageBox::Information, tr("Replay Session"),
+                  SessionRecorder::summary(results), QMessageBox::Close,
+                  this);
+  auto saveButton = box.addButton(tr("Save Report..."),
+                                  QMessageBox::AcceptRole);
+  box.exec();
+  if (box.clickedButton() != saveButton)
+    return;
+
+  auto reportName = QFileDialog::getSaveFileName(
+                      this,
+                      tr("Save latency report"),
+                      QDir::homePath() + "/ftinspect-replay.csv",
+                      tr("CSV files (*.csv);;All files (*)"));
+  if (reportName.isEmpty())
+    return;
+
+  QFile report(reportName);
+  if (!report.open(QIODevice::WriteOnly | QIODevice::Text)
+      || report.write(SessionRecorder::report(results).toUtf8()) < 0)
+    QMessageBox::warning(this, tr("Replay Session"),
+                         tr("Can't write `%1'.").arg(reportName));
+}
+
+
+void
+MainGUI::editGlyphBudgets()
+{
+  GlyphBudgetDialog dialog(this, engine_);
+  if (dialog.exec() == QDialog::Accepted && dialog.apply())
+    reloadCurrentTabFont(); // Retry glyphs rejected so far.
+}
+
+
+bool
+MainGUI::replaySessionHeadless(QString const& tracePath,
+                               QString const& reportPath)
+{
+  QString error;
+  auto results = sessionRecorder_->replay(tracePath, error);
+  if (results.empty())
+  {
+    QTextStream(stderr) << "ftinspect: can't replay `" << tracePath
+                        << "': " << error << '\n';
+    return false;
+  }
+
+  QFile report;
+  if (reportPath.isEmpty())
+    report.open(stdout, QIODevice::WriteOnly | QIODevice::Text);
+  else
+  {
+    report.setFileName(reportPath);
+    if (!report.open(QIODevice::WriteOnly | QIODevice::Text))
+      return false;
+  }
+  report.write(SessionRecorder::report(results).toUtf8());
+  QTextStream(stderr) << SessionRecorder::summary(results) << '\n';
+  return true;
+}
+
+
 void
 MainGUI::createActions()
 {
+  sessionRecorder_ = new SessionRecorder(this);
+  connect(sessionRecorder_, &SessionRecorder::openFontsRequested,
+          this, &MainGUI::openFonts);
+
   loadFontsAct_ = new QAction(tr("&Load Fonts"), this);
   loadFontsAct_->setShortcuts(QKeySequence::Open);
   connect(loadFontsAct_, &QAction::triggered, this, &MainGUI::loadFonts);
@@ -394,6 +567,34 @@ MainGUI::createActions()
   exitAct_->setShortcuts(QKeySequence::Quit);
   connect(exitAct_, &QAction::triggered, this, &MainGUI::close);
 
+  profilerAct_ = new QAction(tr("Sampling &Profiler"), this);
+  profilerAct_->setCheckable(true);
+  profilerAct_->setEnabled(SamplingProfiler::available());
+  profilerAct_->setToolTip(tr("Sample where CPU time is spent until"
+                              " unchecked, then save the stacks"
+                              " for a flame graph"));
+  connect(profilerAct_, &QAction::toggled,
+          this, &MainGUI::toggleProfiler);
+
+  recordSessionAct_ = new QAction(tr("&Record Session"), this);
+  recordSessionAct_->setCheckable(true);
+  recordSessionAct_->setToolTip(tr("Record interactions until unchecked,"
+                                   " then save them as a trace"));
+  connect(recordSessionAct_, &QAction::toggled,
+          this, &MainGUI::toggleSessionRecording);
+
+  replaySessionAct_ = new QAction(tr("Re&play Session..."), this);
+  replaySessionAct_->setToolTip(tr("Replay a recorded trace and report"
+                                   " the latency of each action"));
+  connect(replaySessionAct_, &QAction::triggered,
+          this, &MainGUI::replaySession);
+
+  glyphBudgetsAct_ = new QAction(tr("Glyph &Budgets..."), this);
+  glyphBudgetsAct_->setToolTip(tr("Limit the time and bytecode instructions"
+                                  " spent on loading a single glyph"));
+  connect(glyphBudgetsAct_, &QAction::triggered,
+          this, &MainGUI::editGlyphBudgets);
+
   aboutAct_ = new QAction(tr("&About"), this);
   connect(aboutAct_, &QAction::triggered, this, &MainGUI::about);
 
@@ -410,6 +611,15 @@ MainGUI::createMenus()
   menuFile_->addAction(closeFontAct_);
   menuFile_->addAction(exitAct_);
 
+  menuTools_ = menuBar()->addMenu(tr("&Tools"));
+  menuTools_->addAction(profilerAct_);
+  menuTools_->addSeparator();
+  menuTools_->addAction(recordSessionAct_);
+  menuTools_->addAction(replaySessionAct_);
+  menuTools_->addSeparator();
+  menuTools_->addAction(glyphBudgetsAct_);
+  menuTools_->setToolTipsVisible(true);
+
   menuHelp_ = menuBar()->addMenu(tr("&Help"));
   menuHelp_->addAction(aboutAct_);
   menuHelp_->addAction(aboutQtAct_);
@@ -6,14 +6,17 @@
 
 #pragma once
 
+#include "sessionrecorder.hpp"
 #include "engine/engine.hpp"
 #include "panels/abstracttab.hpp"
 #include "panels/comparator.hpp"
 #include "panels/continuous.hpp"
+#include "panels/fontwall.hpp"
 #include "panels/glyphdetails.hpp"
 #include "panels/info.hpp"
 #include "panels/settingpanel.hpp"
 #include "panels/singular.hpp"
+#include "widgets/glyphbudgetdialog.hpp"
 #include "widgets/tripletselector.hpp"
 
 #include <vector>
@@ -39,6 +42,11 @@ public:
   MainGUI(Engine* engine);
   ~MainGUI() override;
 
+  // Replay a recorded session and write the latency report to `reportPath`
+  // (or standard output if empty); for `ftinspect --replay`.
+  bool replaySessionHeadless(QString const& tracePath,
+                             QString const& reportPath);
+
   friend class Engine;
   friend FT_Error faceRequester(FTC_FaceID,
                                 FT_Library,
@@ -55,6 +63,7 @@ private slots:
   void about();
   void aboutQt();
   void repaintCurrentTab();
+  void recolorCurrentTab();
   void reloadCurrentTabFont();
   void loadFonts();
   void onTripletChanged();
@@ -62,6 +71,10 @@ private slots:
   void switchToSingular(int glyphIndex,
                         double sizePoint);
   void closeDockWidget();
+  void toggleProfiler(bool enabled);
+  void toggleSessionRecording(bool enabled);
+  void replaySession();
+  void editGlyphBudgets();
 
 private:
   Engine* engine_;
@@ -73,7 +86,11 @@ private:
   QAction *aboutQtAct_;
   QAction *closeFontAct_;
   QAction *exitAct_;
+  QAction *glyphBudgetsAct_;
   QAction *loadFontsAct_;
+  QAction *profilerAct_;
+  QAction *recordSessionAct_;
+  QAction *replaySessionAct_;
 
   QVBoxLayout *ftinspectLayout_;
   QHBoxLayout *mainPartLayout_;
@@ -82,6 +99,9 @@ private:
 
   QMenu *menuFile_;
   QMenu *menuHelp_;
+  QMenu *menuTools_;
+
+  SessionRecorder* sessionRecorder_;
 
   TripletSelector* tripletSelector_;
 
@@ -100,6 +120,7 @@ private:
   ContinuousTab* continuousTab_;
   ComparatorTab* comparatorTab_;
   InfoTab* infoTab_;
+  FontWallTab* fontWallTab_;
   QWidget* lastTab_ = NULL;
 
   QDockWidget* glyphDetailsDockWidget_;
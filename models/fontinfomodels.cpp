@@ -8,6 +8,8 @@
 
 #include <cstdint>
 
+#include <QColor>
+
 
 int
 FixedSizeInfoModel::rowCount(const QModelIndex& parent) const
@@ -389,6 +391,94 @@ SFNTTableInfoModel::headerData(int section,
 }
 
 
+int
+ValidationResultModel::rowCount(const QModelIndex& parent) const
+{
+  if (parent.isValid())
+    return 0;
+  return static_cast<int>(storage_.size());
+}
+
+
+int
+ValidationResultModel::columnCount(const QModelIndex& parent) const
+{
+  if (parent.isValid())
+    return 0;
+  return VRM_Max;
+}
+
+
+QVariant
+ValidationResultModel::data(const QModelIndex& index,
+                            int role) const
+{
+  if (index.row() < 0 || index.column() < 0)
+    return {};
+  auto r = static_cast<size_t>(index.row());
+  if (r >= storage_.size())
+    return {};
+
+  auto& obj = storage_[r];
+  if (role == Qt::ForegroundRole)
+  {
+    if (obj.error)
+      return QColor(Qt::red);
+    return {};
+  }
+  if (role != Qt::DisplayRole && role != Qt::ToolTipRole)
+    return {};
+
+  switch (static_cast<Columns>(index.column()))
+  {
+  case VRM_Face:
+    return static_cast<long long>(obj.faceIndex);
+  case VRM_Validator:
+    return ValidationResult::validatorName(obj.validator);
+  case VRM_Table:
+    if (!obj.tag)
+      return "-";
+    return tagToString(obj.tag);
+  case VRM_Result:
+    return obj.message;
+  default:
+    break;
+  }
+
+  return {};
+}
+
+
+QVariant
+ValidationResultModel::headerData(int section,
+                                  Qt::Orientation orientation,
+                                  int role) const
+{
+  if (role != Qt::DisplayRole)
+    return {};
+  if (orientation == Qt::Vertical)
+    return section;
+  if (orientation != Qt::Horizontal)
+    return {};
+
+  switch (static_cast<Columns>(section))
+  {
+  case VRM_Face:
+    return "Face";
+  case VRM_Validator:
+    return "Validator";
+  case VRM_Table:
+    return "Table";
+  case VRM_Result:
+    return "Result";
+  default:
+    ;
+  }
+
+  return {};
+}
+
+
 int
 MMGXAxisInfoModel::rowCount(const QModelIndex& parent) const
 {
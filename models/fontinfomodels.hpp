@@ -7,6 +7,7 @@
 
 #include "../engine/charmap.hpp"
 #include "../engine/fontinfo.hpp"
+#include "../engine/fontvalidator.hpp"
 #include "../engine/mmgx.hpp"
 
 #include <unordered_map>
@@ -178,6 +179,44 @@ private:
 };
 
 
+class ValidationResultModel
+: public QAbstractTableModel
+{
+  Q_OBJECT
+
+public:
+  explicit ValidationResultModel(QObject* parent)
+           : QAbstractTableModel(parent) {}
+  ~ValidationResultModel() override = default;
+
+  int rowCount(const QModelIndex& parent) const override;
+  int columnCount(const QModelIndex& parent) const override;
+  QVariant data(const QModelIndex& index,
+                int role) const override;
+  QVariant headerData(int section,
+                      Qt::Orientation orientation,
+                      int role) const override;
+
+  // The same as `FixedSizeInfoModel`.
+  void beginModelUpdate() { beginResetModel(); }
+  void endModelUpdate() { endResetModel(); }
+  std::vector<ValidationResult>& storage() { return storage_; }
+
+  enum Columns : int
+  {
+    VRM_Face = 0,
+    VRM_Validator,
+    VRM_Table,
+    VRM_Result,
+    VRM_Max
+  };
+
+private:
+  // Don't let the item count exceed INT_MAX!
+  std::vector<ValidationResult> storage_;
+};
+
+
 class MMGXAxisInfoModel
 : public QAbstractTableModel
 {
@@ -0,0 +1,192 @@
+// fontwallmodel.cpp
+
+// Copyright (C) 2022-2023 by
+// Charlie Jiang.
+
+#include "fontwallmodel.hpp"
+
+#include <QFileInfo>
+
+
+FontWallModel::FontWallModel(QObject* parent,
+                             RenderScheduler* scheduler,
+                             RenderWorkerPool* workers)
+: QAbstractListModel(parent),
+  scheduler_(scheduler),
+  workers_(workers),
+  windowFirst_(0),
+  windowLast_(-1)
+{
+}
+
+
+FontWallModel::~FontWallModel()
+{
+  scheduler_->remove(this);
+}
+
+
+int
+FontWallModel::rowCount(const QModelIndex& parent) const
+{
+  if (parent.isValid())
+    return 0;
+  return static_cast<int>(rows_.size());
+}
+
+
+QVariant
+FontWallModel::data(const QModelIndex& index,
+                    int role) const
+{
+  if (index.row() < 0 || index.row() >= rowCount(QModelIndex()))
+    return {};
+
+  auto& row = rows_[index.row()];
+  switch (role)
+  {
+  case Qt::DisplayRole:
+    if (row.state == RS_Done)
+      return row.result.name;
+    return QString("%1 [%2/%3]")
+             .arg(QFileInfo(row.entry.filePath).fileName())
+             .arg(row.entry.faceIndex)
+             .arg(row.entry.namedInstanceIndex);
+  case Qt::ToolTipRole:
+    return row.entry.filePath;
+  case ImageRole:
+    if (row.state == RS_Done)
+      return QVariant::fromValue(row.result.image);
+    break;
+  default:
+    break;
+  }
+
+  return {};
+}
+
+
+void
+FontWallModel::setEntries(std::vector<FontWallEntry> const& entries)
+{
+  cancel();
+
+  beginResetModel();
+  rows_.clear();
+  rows_.resize(entries.size());
+  for (size_t i = 0; i < entries.size(); i++)
+    rows_[i].entry = entries[i];
+  endResetModel();
+}
+
+
+void
+FontWallModel::setParameters(FontWallParameters const& params)
+{
+  if (params == params_)
+    return;
+
+  cancel();
+  params_ = params;
+  for (auto& row : rows_)
+  {
+    row.state = RS_None;
+    row.result = {};
+  }
+
+  if (!rows_.empty())
+    emit dataChanged(index(0), index(static_cast<int>(rows_.size()) - 1));
+}
+
+
+void
+FontWallModel::requestRows(int first,
+                           int last,
+                           int prefetchRows)
+{
+  auto count = static_cast<int>(rows_.size());
+  visibleFirst_ = qMax(first, 0);
+  visibleLast_ = qMin(last, count - 1);
+  windowFirst_ = qMax(first - prefetchRows, 0);
+  windowLast_ = qMin(last + prefetchRows, count - 1);
+
+  // Visible rows first so that they get queued with the higher priority;
+  // the order doesn't matter otherwise.
+  for (int i = visibleFirst_; i <= visibleLast_; i++)
+    if (rows_[i].state == RS_None)
+      startRow(i);
+  for (int i = windowFirst_; i <= windowLast_; i++)
+    if (rows_[i].state == RS_None)
+      startRow(i);
+}
+
+
+void
+FontWallModel::cancel()
+{
+  scheduler_->cancel(this);
+  for (auto& row : rows_)
+    if (row.state == RS_Pending)
+      row.state = RS_None;
+}
+
+
+void
+FontWallModel::rowFinished(int row,
+                           bool rendered,
+                           FontWallResult const& result)
+{
+  if (row < 0 || row >= static_cast<int>(rows_.size()))
+    return;
+
+  auto& r = rows_[row];
+  if (r.state != RS_Pending)
+    return;
+
+  if (!rendered)
+  {
+    // Skipped since the row had been scrolled out of view; it may have come
+    // back in the meantime, though.
+    r.state = RS_None;
+    if (row >= windowFirst_ && row <= windowLast_)
+      startRow(row);
+    return;
+  }
+
+  r.state = RS_Done;
+  r.result = result;
+  emit dataChanged(index(row), index(row));
+}
+
+
+void
+FontWallModel::startRow(int row)
+{
+  rows_[row].state = RS_Pending;
+
+  auto priority = row >= visibleFirst_ && row <= visibleLast_
+                  ? RenderScheduler::P_Visible
+                  : RenderScheduler::P_Prefetch;
+  auto entry = rows_[row].entry;
+  auto params = params_;
+  scheduler_->submit(this, priority,
+                     [this, row, entry, params]
+                     {
+                       FontWallResult result;
+                       bool rendered = row >= windowFirst_
+                                       && row <= windowLast_;
+                       if (rendered)
+                         result = params.isolated
+                                    ? workers_->render(entry, params)
+                                    : FontWallRenderer::render(entry,
+                                                               params);
+
+                       return [this, row, rendered, result]
+                              {
+                                rowFinished(row, rendered, result);
+                              };
+                     });
+}
+
+
+// end of fontwallmodel.cpp
@@ -0,0 +1,90 @@
+// fontwallmodel.hpp
+
+// Copyright (C) 2022-2023 by
+// Charlie Jiang.
+
+#pragma once
+
+#include "../engine/fontwall.hpp"
+#include "../engine/renderscheduler.hpp"
+#include "../engine/renderworker.hpp"
+
+#include <atomic>
+#include <vector>
+
+#include <QAbstractListModel>
+#include <QImage>
+
+
+// The rows of the font wall.  Rows are rendered on demand by the render
+// scheduler and the resulting images are kept per row until the parameters
+// change.  Only rows the view asks for with `requestRows` are rendered,
+// visible rows before prefetched ones; a queued row is dropped when its job
+// starts and the row has left the requested window by then, so fast
+// scrolling over hundreds of fonts doesn't pile up work.
+class FontWallModel
+: public QAbstractListModel
+{
+  Q_OBJECT
+
+public:
+  enum Roles : int
+  {
+    ImageRole = Qt::UserRole + 1
+  };
+
+  FontWallModel(QObject* parent,
+                RenderScheduler* scheduler,
+                RenderWorkerPool* workers);
+  ~FontWallModel() override;
+
+  int rowCount(const QModelIndex& parent) const override;
+  QVariant data(const QModelIndex& index,
+                int role) const override;
+
+  void setEntries(std::vector<FontWallEntry> const& entries);
+  // Drops all cached rows if the parameters differ from the current ones.
+  void setParameters(FontWallParameters const& params);
+  FontWallParameters const& parameters() { return params_; }
+
+  // Render rows in [`first`, `last`] that aren't cached yet, plus
+  // `prefetchRows` rows above and below with a lower priority.
+  void requestRows(int first,
+                   int last,
+                   int prefetchRows);
+  void cancel();
+
+private:
+  enum RowState : int
+  {
+    RS_None,
+    RS_Pending,
+    RS_Done
+  };
+
+  struct Row
+  {
+    FontWallEntry entry;
+    RowState state = RS_None;
+    FontWallResult result;
+  };
+
+  RenderScheduler* scheduler_;
+  RenderWorkerPool* workers_;
+  std::vector<Row> rows_;
+  FontWallParameters params_;
+
+  int visibleFirst_ = 0;
+  int visibleLast_ = -1;
+  // Read by the workers.
+  std::atomic<int> windowFirst_;
+  std::atomic<int> windowLast_;
+
+  void startRow(int row);
+  void rowFinished(int row,
+                   bool rendered,
+                   FontWallResult const& result);
+};
+
+
+// end of fontwallmodel.hpp
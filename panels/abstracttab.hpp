@@ -16,6 +16,9 @@ public:
 
   virtual void repaintGlyph() = 0;
   virtual void reloadFont() = 0;
+  // Only colors or gamma changed; tabs that cache rendered images can retint
+  // them instead of rendering again.
+  virtual void recolorGlyph() { repaintGlyph(); }
 };
 
 
@@ -49,6 +49,21 @@ ComparatorTab::repaintGlyph()
 }
 
 
+void
+ComparatorTab::recolorColumn(int index)
+{
+  if (index < 0 || static_cast<unsigned>(index) >= canvas_.size())
+    return;
+
+  // Colors only affect the column's own canvas.
+  settingPanels_[index]->applySettings();
+  if (canvas_[index]->retintCache())
+    canvas_[index]->repaint();
+  else
+    repaintGlyph();
+}
+
+
 void
 ComparatorTab::reloadFont()
 {
@@ -95,6 +110,10 @@ ComparatorTab::createLayout()
   charMapSelector_ = new CharMapComboBox(this, engine_, false);
   sourceTextEdit_ = new QPlainTextEdit(QString(ComparatorDefaultText), this);
 
+  sourceTextTimer_ = new QTimer(this);
+  sourceTextTimer_->setSingleShot(true);
+  sourceTextTimer_->setInterval(TextUpdateDelayMs);
+
   sizeSelector_->installEventFilterForWidget(this);
 
   for (int i = 0; i < ColumnWidth; ++i)
@@ -159,18 +178,23 @@ ComparatorTab::createConnections()
           this, &ComparatorTab::reloadGlyphsAndRepaint);
   connect(sourceTextEdit_, &QPlainTextEdit::textChanged,
           this, &ComparatorTab::sourceTextChanged);
+  connect(sourceTextTimer_, &QTimer::timeout,
+          this, &ComparatorTab::updateSourceText);
   connect(charMapSelector_,
           QOverload<int>::of(&CharMapComboBox::currentIndexChanged),
           this, &ComparatorTab::reloadStringAndRepaint);
 
-  for (auto panel : settingPanels_)
+  for (size_t i = 0; i < settingPanels_.size(); i++)
   {
+    auto panel = settingPanels_[i];
     // We're treating the two events identically because we need to do a
     // complete flush anyway.
     connect(panel, &SettingPanel::repaintNeeded,
             this, &ComparatorTab::repaintGlyph);
     connect(panel, &SettingPanel::fontReloadNeeded,
             this, &ComparatorTab::repaintGlyph);
+    connect(panel, &SettingPanel::recolorNeeded,
+            this, [this, i] { recolorColumn(static_cast<int>(i)); });
   }
 
   for (auto canvas : canvas_)
@@ -195,7 +219,7 @@ ComparatorTab::setupCanvases()
 
     canvas->installEventFilter(this);
   }
-  sourceTextChanged();
+  reloadStringAndRepaint();
 }
 
 
@@ -250,9 +274,27 @@ ComparatorTab::reloadGlyphsAndRepaint()
 void
 ComparatorTab::sourceTextChanged()
 {
+  sourceTextTimer_->start(); // Restarts if already running.
+}
+
+
+void
+ComparatorTab::updateSourceText()
+{
+  auto text = sourceTextEdit_->toPlainText();
+  sizeSelector_->applyToEngine(engine_);
+
+  int i = 0;
   for (auto canvas : canvas_)
-    canvas->setSourceText(sourceTextEdit_->toPlainText());
-  reloadStringAndRepaint();
+  {
+    applySettings(i);
+    // Unlike `repaintGlyph`, don't reload all glyphs or drop the canvas's
+    // image pool: the settings are the same as for the last paint, so only
+    // the changed characters need to be loaded and rendered.
+    canvas->updateSourceText(text);
+    canvas->repaint();
+    i++;
+  }
 }
 
 
@@ -20,6 +20,7 @@
 #include <QGridLayout>
 #include <QLabel>
 #include <QPlainTextEdit>
+#include <QTimer>
 #include <QWidget>
 
 
@@ -44,6 +45,8 @@ protected:
 
 private:
   constexpr static int ColumnWidth = 3;
+  // Text edits are collected for this time before the columns are updated.
+  constexpr static int TextUpdateDelayMs = 150;
 
   Engine* engine_;
 
@@ -51,6 +54,7 @@ private:
   QLabel* charMapLabel_;
   CharMapComboBox* charMapSelector_;
   QPlainTextEdit* sourceTextEdit_;
+  QTimer* sourceTextTimer_;
 
   std::vector<GlyphContinuous*> canvas_;
   std::vector<SettingPanel*> settingPanels_;
@@ -68,7 +72,9 @@ private:
 
   void reloadStringAndRepaint();
   void reloadGlyphsAndRepaint();
+  void recolorColumn(int index);
   void sourceTextChanged();
+  void updateSourceText();
   void applySettings(int index);
 
   void wheelResize(int steps);
@@ -7,8 +7,10 @@
 #include "glyphdetails.hpp"
 #include "../uihelper.hpp"
 
+#include <algorithm>
 #include <climits>
 
+#include <QHeaderView>
 #include <QToolTip>
 #include <QVariant>
 
@@ -43,6 +45,15 @@ ContinuousTab::repaintGlyph()
   canvas_->stopFlashing();
   canvas_->purgeCache();
   canvas_->repaint();
+  checkHeatmap();
+}
+
+
+void
+ContinuousTab::recolorGlyph()
+{
+  canvas_->retintCache(); // If this fails, the cache is refilled on repaint.
+  canvas_->repaint();
 }
 
 
@@ -61,6 +72,7 @@ ContinuousTab::reloadFont()
   canvas_->stopFlashing();
   canvas_->stringRenderer().reloadAll();
   canvas_->purgeCache();
+  glyphTimer_->clear(); // Restarted by `repaintGlyph` if needed.
   repaintGlyph();
 }
 
@@ -80,6 +92,7 @@ ContinuousTab::applySettings()
   sr.setWaterfall(waterfallCheckBox_->isChecked());
   sr.setVertical(verticalCheckBox_->isChecked());
   sr.setKerning(kerningCheckBox_->isChecked());
+  sr.setFontFallback(fallbackCheckBox_->isChecked());
   sr.setRotation(rotationSpinBox_->value());
 
   // -1: Glyph order, otherwise the char map index in the original list.
@@ -158,6 +171,8 @@ ContinuousTab::checkModeSource()
     if (!isText)
       kerningCheckBox_->setChecked(false);
   }
+  fallbackCheckBox_->setEnabled(isText);
+  heatmapCheckBox_->setEnabled(src == GlyphContinuous::SRC_AllGlyphs);
 
   canvas_->setSource(src);
 
@@ -205,6 +220,15 @@ ContinuousTab::charMapChanged()
 }
 
 
+void
+ContinuousTab::fontFallbackChanged()
+{
+  applySettings();
+  canvas_->stringRenderer().reloadAll(); // Reassign glyphs to fonts.
+  repaintGlyph();
+}
+
+
 void
 ContinuousTab::sourceTextChanged()
 {
@@ -259,6 +283,64 @@ ContinuousTab::openWaterfallConfig()
 }
 
 
+void
+ContinuousTab::heatmapChanged()
+{
+  canvas_->setHeatmap(heatmapCheckBox_->isChecked() ? glyphTimer_ : NULL);
+  checkHeatmap();
+  canvas_->update();
+}
+
+
+void
+ContinuousTab::checkHeatmap()
+{
+  // The canvas has just been painted, so the engine is set up for the
+  // current font and settings.
+  if (!heatmapCheckBox_->isChecked()
+      || sourceSelector_->currentIndex() != GlyphContinuous::SRC_AllGlyphs
+      || !engine_->fontValid())
+    return;
+
+  if (!glyphTimer_->matches(engine_))
+    glyphTimer_->measure(engine_);
+}
+
+
+void
+ContinuousTab::heatmapProgress(int finishedGlyphs,
+                               int totalGlyphs)
+{
+  heatmapStatusLabel_->setText(
+    tr("Measuring: %1/%2").arg(finishedGlyphs).arg(totalGlyphs));
+  canvas_->update(); // The images are cached, only the tint changes.
+}
+
+
+void
+ContinuousTab::heatmapFinished()
+{
+  auto reference = glyphTimer_->referenceTime();
+  if (reference > 0)
+    heatmapStatusLabel_->setText(
+      tr("Median: %1 \u00B5s").arg(reference / 1000.0, 0, 'f', 1));
+  else
+    heatmapStatusLabel_->clear();
+
+  if (timingDialog_->isVisible())
+    timingDialog_->updateTimes(glyphTimer_->times());
+  canvas_->update();
+}
+
+
+void
+ContinuousTab::openSlowestGlyphs()
+{
+  timingDialog_->updateTimes(glyphTimer_->times());
+  timingDialog_->setVisible(true); // No `exec`: not modal.
+}
+
+
 void
 ContinuousTab::showToolTip()
 {
@@ -355,6 +437,8 @@ ContinuousTab::createLayout()
   verticalCheckBox_ = new QCheckBox(tr("Vertical"), this);
   waterfallCheckBox_ = new QCheckBox(tr("Waterfall"), this);
   kerningCheckBox_ = new QCheckBox(tr("Kerning"), this);
+  fallbackCheckBox_ = new QCheckBox(tr("Fallback"), this);
+  heatmapCheckBox_ = new QCheckBox(tr("Load Time Heatmap"), this);
 
   modeLabel_ = new QLabel(tr("Mode:"), this);
   sourceLabel_ = new QLabel(tr("Text Source:"), this);
@@ -364,9 +448,11 @@ ContinuousTab::createLayout()
   slantLabel_ = new QLabel(tr("Slanting:"), this);
   strokeRadiusLabel_ = new QLabel(tr("Stroke Radius:"), this);
   rotationLabel_ = new QLabel(tr("Rotation:"), this);
+  heatmapStatusLabel_ = new QLabel(this);
 
   resetPositionButton_ = new QPushButton(tr("Reset Pos"), this);
   waterfallConfigButton_ = new QPushButton(tr("WF Config"), this);
+  slowestGlyphsButton_ = new QPushButton(tr("Slowest Glyphs"), this);
   helpButton_ = new QPushButton(this);
   helpButton_->setText(tr("?"));
 
@@ -393,6 +479,8 @@ ContinuousTab::createLayout()
   rotationSpinBox_->setMaximum(180);
 
   wfConfigDialog_ = new WaterfallConfigDialog(this);
+  timingDialog_ = new GlyphTimingDialog(this, engine_);
+  glyphTimer_ = new GlyphTimer(this, engine_->renderScheduler());
 
   // Tooltips
   sourceSelector_->setToolTip(tr(
@@ -427,6 +515,18 @@ ContinuousTab::createLayout()
     "when source set to Text String)"));
   kerningCheckBox_->setToolTip(tr(
     "Enable kerning (GPOS table unsupported)"));
+  fallbackCheckBox_->setToolTip(tr(
+    "Take characters missing in the current font from the first\n"
+    "opened font that covers them (only available when source set\n"
+    "to Text String and a Unicode char map is used)"));
+  heatmapCheckBox_->setToolTip(tr(
+    "Tint each glyph by the time needed to load and render it\n"
+    "(green: typical, red: 16 times the median or slower).\n"
+    "Measured in the background with the current size and settings\n"
+    "(only available when source set to All Glyphs)."));
+  slowestGlyphsButton_->setToolTip(tr(
+    "List the glyphs that are slowest to load and render\n"
+    "(needs a heatmap measurement)."));
   helpButton_->setToolTip(tr("Get mouse helps"));
 
   // Layouting
@@ -438,6 +538,9 @@ ContinuousTab::createLayout()
 
   sizeHelpLayout_ = new QHBoxLayout;
   sizeHelpLayout_->addWidget(sizeSelector_, 1, Qt::AlignVCenter);
+  sizeHelpLayout_->addWidget(heatmapCheckBox_, 0);
+  sizeHelpLayout_->addWidget(heatmapStatusLabel_, 0);
+  sizeHelpLayout_->addWidget(slowestGlyphsButton_, 0);
   sizeHelpLayout_->addWidget(helpButton_, 0);
 
   bottomLayout_ = new QGridLayout;
@@ -468,6 +571,7 @@ ContinuousTab::createLayout()
   bottomLayout_->addWidget(kerningCheckBox_, 3, 6);
   bottomLayout_->addWidget(waterfallConfigButton_, 1, 5);
   bottomLayout_->addWidget(sampleStringSelector_, 2, 5);
+  bottomLayout_->addWidget(fallbackCheckBox_, 3, 5);
 
   bottomLayout_->setColumnStretch(4, 1);
 
@@ -522,6 +626,17 @@ ContinuousTab::createConnections()
   connect(wfConfigDialog_, &WaterfallConfigDialog::sizeUpdated,
           this, &ContinuousTab::repaintGlyph);
 
+  connect(heatmapCheckBox_, &QCheckBox::clicked,
+          this, &ContinuousTab::heatmapChanged);
+  connect(slowestGlyphsButton_, &QPushButton::clicked,
+          this, &ContinuousTab::openSlowestGlyphs);
+  connect(glyphTimer_, &GlyphTimer::progress,
+          this, &ContinuousTab::heatmapProgress);
+  connect(glyphTimer_, &GlyphTimer::finished,
+          this, &ContinuousTab::heatmapFinished);
+  connect(timingDialog_, &GlyphTimingDialog::glyphActivated,
+          [this](int index) { emit switchToSingular(index, -1); });
+
   connect(xEmboldeningSpinBox_,
           QOverload<double>::of(&QDoubleSpinBox::valueChanged),
           this, &ContinuousTab::repaintGlyph);
@@ -544,6 +659,8 @@ ContinuousTab::createConnections()
           this, &ContinuousTab::checkModeSourceAndRepaint);
   connect(kerningCheckBox_, &QCheckBox::clicked,
           this, &ContinuousTab::reloadGlyphsAndRepaint);
+  connect(fallbackCheckBox_, &QCheckBox::clicked,
+          this, &ContinuousTab::fontFallbackChanged);
   connect(sourceTextEdit_, &QPlainTextEdit::textChanged,
           this, &ContinuousTab::sourceTextChanged);
   connect(sampleStringSelector_,
@@ -690,6 +807,93 @@ WaterfallConfigDialog::checkAutoStatus()
 }
 
 
+GlyphTimingDialog::GlyphTimingDialog(QWidget* parent,
+                                     Engine* engine)
+: QDialog(parent),
+  engine_(engine)
+{
+  setModal(false);
+  setWindowTitle(tr("Slowest Glyphs"));
+  setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint);
+
+  createLayout();
+  createConnections();
+}
+
+
+void
+GlyphTimingDialog::updateTimes(std::vector<qint64> const& times)
+{
+  std::vector<int> indices;
+  for (size_t i = 0; i < times.size(); i++)
+    if (times[i] >= 0)
+      indices.push_back(static_cast<int>(i));
+
+  auto count = std::min(indices.size(), static_cast<size_t>(MaxRows));
+  std::partial_sort(indices.begin(), indices.begin() + count, indices.end(),
+                    [&](int a, int b) { return times[a] > times[b]; });
+  indices.resize(count);
+
+  table_->setSortingEnabled(false); // Don't resort while filling.
+  table_->setRowCount(static_cast<int>(count));
+  for (int row = 0; row < static_cast<int>(count); row++)
+  {
+    auto index = indices[row];
+
+    auto indexItem = new QTableWidgetItem;
+    indexItem->setData(Qt::DisplayRole, index);
+    auto nameItem = new QTableWidgetItem(engine_->glyphName(index));
+    auto timeItem = new QTableWidgetItem;
+    timeItem->setData(Qt::DisplayRole, times[index] / 1000.0);
+
+    table_->setItem(row, 0, indexItem);
+    table_->setItem(row, 1, nameItem);
+    table_->setItem(row, 2, timeItem);
+  }
+  table_->setSortingEnabled(true);
+  table_->sortByColumn(2, Qt::DescendingOrder);
+}
+
+
+void
+GlyphTimingDialog::createLayout()
+{
+  table_ = new QTableWidget(this);
+  table_->setColumnCount(3);
+  table_->setHorizontalHeaderLabels({ tr("Glyph"), tr("Name"),
+                                      tr("Time (\u00B5s)") });
+  table_->setEditTriggers(QAbstractItemView::NoEditTriggers);
+  table_->setSelectionBehavior(QAbstractItemView::SelectRows);
+  table_->verticalHeader()->hide();
+  table_->horizontalHeader()->setStretchLastSection(true);
+
+  // Tooltips
+  table_->setToolTip(tr(
+    "Median time to load and render each glyph.\n"
+    "Double-click to inspect a glyph in the Singular Grid View."));
+
+  // Layouting
+  layout_ = new QVBoxLayout;
+  layout_->addWidget(table_);
+
+  setLayout(layout_);
+  resize(400, 500);
+}
+
+
+void
+GlyphTimingDialog::createConnections()
+{
+  connect(table_, &QTableWidget::cellDoubleClicked,
+          [this](int row, int)
+          {
+            auto item = table_->item(row, 0);
+            if (item)
+              emit glyphActivated(item->data(Qt::DisplayRole).toInt());
+          });
+}
+
+
 const char* StringSamples[] = {
   "The quick brown fox jumps over the lazy dog",
 
@@ -7,6 +7,7 @@
 
 #include "abstracttab.hpp"
 #include "../engine/engine.hpp"
+#include "../engine/glyphtimer.hpp"
 #include "../glyphcomponents/glyphcontinuous.hpp"
 #include "../glyphcomponents/graphicsdefault.hpp"
 #include "../widgets/charmapcombobox.hpp"
@@ -25,10 +26,12 @@
 #include <QGridLayout>
 #include <QLabel>
 #include <QPlainTextEdit>
+#include <QTableWidget>
 #include <QWidget>
 
 
 class GlyphDetails;
+class GlyphTimingDialog;
 class WaterfallConfigDialog;
 
 class ContinuousTab
@@ -46,6 +49,7 @@ public:
 
   void repaintGlyph() override;
   void reloadFont() override;
+  void recolorGlyph() override;
   void highlightGlyph(int index);
   void applySettings();
 
@@ -76,6 +80,7 @@ private:
 
   QPushButton* resetPositionButton_;
   QPushButton* waterfallConfigButton_;
+  QPushButton* slowestGlyphsButton_;
   QPushButton* helpButton_;
 
   QLabel* modeLabel_;
@@ -86,6 +91,7 @@ private:
   QLabel* slantLabel_;
   QLabel* strokeRadiusLabel_;
   QLabel* rotationLabel_;
+  QLabel* heatmapStatusLabel_;
 
   QDoubleSpinBox* xEmboldeningSpinBox_;
   QDoubleSpinBox* yEmboldeningSpinBox_;
@@ -96,6 +102,8 @@ private:
   QCheckBox* verticalCheckBox_;
   QCheckBox* waterfallCheckBox_;
   QCheckBox* kerningCheckBox_;
+  QCheckBox* fallbackCheckBox_;
+  QCheckBox* heatmapCheckBox_;
 
   GlyphIndexSelector* indexSelector_;
   QPlainTextEdit* sourceTextEdit_;
@@ -109,6 +117,8 @@ private:
   GlyphDetails* glyphDetails_;
 
   WaterfallConfigDialog* wfConfigDialog_;
+  GlyphTimingDialog* timingDialog_;
+  GlyphTimer* glyphTimer_;
 
   void createLayout();
   void createConnections();
@@ -123,6 +133,7 @@ private:
   void setGlyphBeginindex(int index);
   void checkModeSourceAndRepaint();
   void charMapChanged();
+  void fontFallbackChanged();
   void sourceTextChanged();
   void presetStringSelected();
   void reloadGlyphsAndRepaint();
@@ -130,6 +141,12 @@ private:
                           int charMapIndex,
                           bool open);
   void openWaterfallConfig();
+  void heatmapChanged();
+  void checkHeatmap();
+  void heatmapProgress(int finishedGlyphs,
+                       int totalGlyphs);
+  void heatmapFinished();
+  void openSlowestGlyphs();
   void showToolTip();
 
   void wheelNavigate(int steps);
@@ -173,4 +190,32 @@ private:
 };
 
 
+// A sortable list of the glyphs that take longest to load and render.
+class GlyphTimingDialog
+: public QDialog
+{
+  Q_OBJECT
+
+public:
+  GlyphTimingDialog(QWidget* parent,
+                    Engine* engine);
+
+  void updateTimes(std::vector<qint64> const& times);
+
+signals:
+  void glyphActivated(int glyphIndex);
+
+private:
+  constexpr static int MaxRows = 200;
+
+  Engine* engine_;
+
+  QTableWidget* table_;
+  QVBoxLayout* layout_;
+
+  void createLayout();
+  void createConnections();
+};
+
+
 // end of continuous.hpp
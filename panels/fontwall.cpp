@@ -0,0 +1,220 @@
+// fontwall.cpp
+
+// Copyright (C) 2022-2023 by
+// Charlie Jiang.
+
+#include "fontwall.hpp"
+
+#include <QPainter>
+#include <QScrollBar>
+
+
+namespace
+{
+
+constexpr int RowMargin = 4;
+
+} // namespace
+
+
+void
+FontWallDelegate::paint(QPainter* painter,
+                        const QStyleOptionViewItem& option,
+                        const QModelIndex& index) const
+{
+  painter->save();
+
+  if (option.state & QStyle::State_Selected)
+    painter->fillRect(option.rect, option.palette.highlight());
+
+  auto nameRect = option.rect.adjusted(RowMargin, RowMargin, -RowMargin, 0);
+  nameRect.setHeight(option.fontMetrics.height());
+  painter->setPen(option.palette.color(QPalette::Text));
+  painter->drawText(nameRect, Qt::AlignLeft | Qt::AlignVCenter,
+                    index.data().toString());
+
+  auto image = index.data(FontWallModel::ImageRole).value<QImage>();
+  if (!image.isNull())
+    painter->drawImage(QPoint(nameRect.left(), nameRect.bottom() + 1),
+                       image);
+
+  painter->setPen(option.palette.color(QPalette::Mid));
+  painter->drawLine(option.rect.bottomLeft(), option.rect.bottomRight());
+
+  painter->restore();
+}
+
+
+QSize
+FontWallDelegate::sizeHint(const QStyleOptionViewItem& option,
+                           const QModelIndex& index) const
+{
+  Q_UNUSED(index)
+  return { option.rect.width(),
+           option.fontMetrics.height() + imageHeight_ + 3 * RowMargin };
+}
+
+
+FontWallTab::FontWallTab(QWidget* parent,
+                         Engine* engine)
+: QWidget(parent),
+  engine_(engine)
+{
+  createLayout();
+  createConnections();
+}
+
+
+void
+FontWallTab::repaintGlyph()
+{
+  updateParameters();
+}
+
+
+void
+FontWallTab::reloadFont()
+{
+  // Switching triplets doesn't change the wall; only rebuild the rows when
+  // fonts are opened or closed.
+  QStringList files;
+  auto& manager = engine_->fontFileManager();
+  for (int i = 0; i < manager.size(); i++)
+    files.append(manager[i].filePath());
+
+  if (files != fontFiles_)
+  {
+    fontFiles_ = files;
+    model_->setEntries(FontWallRenderer::enumerate(fontFiles_));
+    countLabel_->setText(tr("%n face(s)", "", model_->rowCount({})));
+  }
+
+  repaintGlyph();
+}
+
+
+void
+FontWallTab::resizeEvent(QResizeEvent* event)
+{
+  QWidget::resizeEvent(event);
+  updateParameters();
+}
+
+
+void
+FontWallTab::updateParameters()
+{
+  FontWallParameters params;
+  params.text = textEdit_->text();
+  params.pixelSize = sizeSpinBox_->value();
+  params.maxWidth = qMax(listView_->viewport()->width() - 2 * RowMargin,
+                         1);
+
+  params.loadFlags = engine_->doHinting() ? FT_LOAD_DEFAULT
+                                          : FT_LOAD_NO_HINTING;
+  if (!engine_->antiAliasingEnabled())
+    params.loadFlags |= FT_LOAD_TARGET_MONO;
+  params.isolated = isolateCheckBox_->isChecked();
+
+  if (params != model_->parameters())
+  {
+    delegate_->setImageHeight(params.imageHeight());
+    model_->setParameters(params);
+    // Row heights are cached by the view.
+    listView_->doItemsLayout();
+  }
+
+  requestVisibleRows();
+}
+
+
+void
+FontWallTab::requestVisibleRows()
+{
+  auto count = model_->rowCount({});
+  if (count <= 0)
+    return;
+
+  // Computed instead of using `indexAt` so that it also works before the
+  // view has laid out the rows.
+  auto rowHeight = qMax(listView_->sizeHintForRow(0), 1);
+  auto first = listView_->verticalScrollBar()->value() / rowHeight;
+  auto last = first + listView_->viewport()->height() / rowHeight + 1;
+
+  model_->requestRows(first, last, PrefetchRows);
+}
+
+
+void
+FontWallTab::createLayout()
+{
+  textLabel_ = new QLabel(tr("Text:"), this);
+  textEdit_ = new QLineEdit(
+    tr("The quick brown fox jumps over the lazy dog."), this);
+  sizeLabel_ = new QLabel(tr("Size:"), this);
+  sizeSpinBox_ = new QSpinBox(this);
+  sizeSpinBox_->setRange(6, 200);
+  sizeSpinBox_->setValue(24);
+  sizeSpinBox_->setSuffix(tr(" px"));
+  isolateCheckBox_ = new QCheckBox(tr("Isolate Crashes"), this);
+  isolateCheckBox_->setEnabled(RenderWorkerPool::available());
+  countLabel_ = new QLabel(this);
+
+  model_ = new FontWallModel(this, engine_->renderScheduler(),
+                             engine_->renderWorkers());
+  delegate_ = new FontWallDelegate(this);
+
+  listView_ = new QListView(this);
+  listView_->setModel(model_);
+  listView_->setItemDelegate(delegate_);
+  // All rows have the same height; this lets the view skip laying out
+  // invisible rows.
+  listView_->setUniformItemSizes(true);
+  listView_->setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
+  listView_->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+
+  // Tooltips
+  textEdit_->setToolTip(tr("Sample string shown in every face"));
+  sizeSpinBox_->setToolTip(tr("Pixel size of the sample string"));
+  isolateCheckBox_->setToolTip(tr(
+    "Render rows in separate worker processes so that a broken font\n"
+    "can't crash ftinspect; only its row shows an error.\n"
+    "Only available on Linux."));
+  listView_->setToolTip(tr(
+    "All faces and named instances of the opened fonts.\n"
+    "Hinting and anti-aliasing follow the settings panel."));
+
+  // Layouting
+  topLayout_ = new QHBoxLayout;
+  topLayout_->addWidget(textLabel_);
+  topLayout_->addWidget(textEdit_, 1);
+  topLayout_->addWidget(sizeLabel_);
+  topLayout_->addWidget(sizeSpinBox_);
+  topLayout_->addWidget(isolateCheckBox_);
+  topLayout_->addWidget(countLabel_);
+
+  mainLayout_ = new QVBoxLayout;
+  mainLayout_->addLayout(topLayout_);
+  mainLayout_->addWidget(listView_, 1);
+  setLayout(mainLayout_);
+}
+
+
+void
+FontWallTab::createConnections()
+{
+  connect(textEdit_, &QLineEdit::textChanged,
+          this, &FontWallTab::updateParameters);
+  connect(sizeSpinBox_, QOverload<int>::of(&QSpinBox::valueChanged),
+          this, &FontWallTab::updateParameters);
+  connect(isolateCheckBox_, &QCheckBox::toggled,
+          this, &FontWallTab::updateParameters);
+
+  connect(listView_->verticalScrollBar(), &QScrollBar::valueChanged,
+          this, &FontWallTab::requestVisibleRows);
+  connect(model_, &QAbstractItemModel::modelReset,
+          this, &FontWallTab::requestVisibleRows);
+}
+
+
+// end of fontwall.cpp
@@ -0,0 +1,95 @@
+// fontwall.hpp
+
+// Copyright (C) 2022-2023 by
+// Charlie Jiang.
+
+#pragma once
+
+#include "abstracttab.hpp"
+#include "../engine/engine.hpp"
+#include "../models/fontwallmodel.hpp"
+
+#include <QBoxLayout>
+#include <QCheckBox>
+#include <QLabel>
+#include <QLineEdit>
+#include <QListView>
+#include <QSpinBox>
+#include <QStyledItemDelegate>
+#include <QWidget>
+
+
+// Paints a row of the font wall: the face name above the rendered sample.
+class FontWallDelegate
+: public QStyledItemDelegate
+{
+public:
+  explicit FontWallDelegate(QObject* parent)
+           : QStyledItemDelegate(parent) {}
+  ~FontWallDelegate() override = default;
+
+  void setImageHeight(int height) { imageHeight_ = height; }
+
+  void paint(QPainter* painter,
+             const QStyleOptionViewItem& option,
+             const QModelIndex& index) const override;
+  QSize sizeHint(const QStyleOptionViewItem& option,
+                 const QModelIndex& index) const override;
+
+private:
+  int imageHeight_ = 36;
+};
+
+
+// Show one sample string in all faces and named instances of all opened
+// fonts at once.  Rows are rendered asynchronously and only while (nearly)
+// visible.
+class FontWallTab
+: public QWidget,
+  public AbstractTab
+{
+  Q_OBJECT
+
+public:
+  FontWallTab(QWidget* parent,
+              Engine* engine);
+  ~FontWallTab() override = default;
+
+  void repaintGlyph() override;
+  void reloadFont() override;
+
+protected:
+  void resizeEvent(QResizeEvent* event) override;
+
+private slots:
+  void updateParameters();
+  void requestVisibleRows();
+
+private:
+  // Rows rendered above and below the visible ones so that scrolling by a
+  // few rows doesn't show empty rows.
+  constexpr static int PrefetchRows = 10;
+
+  Engine* engine_;
+  QStringList fontFiles_;
+
+  FontWallModel* model_;
+  FontWallDelegate* delegate_;
+
+  QLabel* textLabel_;
+  QLabel* sizeLabel_;
+  QLabel* countLabel_;
+  QLineEdit* textEdit_;
+  QSpinBox* sizeSpinBox_;
+  QCheckBox* isolateCheckBox_;
+  QListView* listView_;
+
+  QHBoxLayout* topLayout_;
+  QVBoxLayout* mainLayout_;
+
+  void createLayout();
+  void createConnections();
+};
+
+
+// end of fontwall.hpp
@@ -55,12 +55,16 @@ GlyphDetails::updateGlyph(GlyphCacheEntry& ctxt,
 
   auto rect = ctxt.basePosition.translated(-(ctxt.penPos.x()),
                                            -(ctxt.penPos.y()));
-  bitmapWidget_->updateImage(ctxt.image,
-                             rect,
-                             QRect(0,
-                                   -metrics.y_ppem,
-                                   metrics.y_ppem,
-                                   metrics.y_ppem));
+  // Huge glyphs are drawn as paths and have no image.
+  if (ctxt.image)
+    bitmapWidget_->updateImage(ctxt.image.get(),
+                               rect,
+                               QRect(0,
+                                     -metrics.y_ppem,
+                                     metrics.y_ppem,
+                                     metrics.y_ppem));
+  else
+    bitmapWidget_->releaseImage();
 
   // Load glyphs in all units.
   dpi_ = engine_->dpi();
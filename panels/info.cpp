@@ -44,6 +44,7 @@ InfoTab::createLayout()
   postScriptTab_ = new PostScriptInfoTab(this, engine_);
   mmgxTab_ = new MMGXInfoTab(this, engine_);
   compositeGlyphsTab_ = new CompositeGlyphsTab(this, engine_);
+  validationTab_ = new ValidationTab(this, engine_);
 
   tab_ = new QTabWidget(this);
   tab_->addTab(generalTab_, tr("General"));
@@ -51,12 +52,14 @@ InfoTab::createLayout()
   tab_->addTab(postScriptTab_, tr("PostScript"));
   tab_->addTab(mmgxTab_, tr("MM/GX"));
   tab_->addTab(compositeGlyphsTab_, tr("Composite Glyphs"));
+  tab_->addTab(validationTab_, tr("Validation"));
 
   tabs_.append(generalTab_);
   tabs_.append(sfntTab_);
   tabs_.append(postScriptTab_);
   tabs_.append(mmgxTab_);
   tabs_.append(compositeGlyphsTab_);
+  tabs_.append(validationTab_);
 
   layout_ = new QHBoxLayout;
   layout_->addWidget(tab_);
@@ -1059,4 +1062,152 @@ CompositeGlyphsTab::treeRowDoubleClicked(const QModelIndex& idx)
 }
 
 
+
+ValidationTab::ValidationTab(QWidget* parent,
+                             Engine* engine)
+: QWidget(parent),
+  engine_(engine)
+{
+  createLayout();
+  createConnections();
+}
+
+
+void
+ValidationTab::reloadFont()
+{
+  auto face = engine_->currentFallbackFtFace();
+  setEnabled(face && FT_IS_SFNT(face));
+
+  // Results stay valid while the same font file is shown.
+  if (engine_->currentFontIndex() != validatedFontIndex_)
+    clearResults();
+}
+
+
+void
+ValidationTab::createLayout()
+{
+  validator_ = new FontValidator(this, engine_->renderScheduler());
+
+  validateButton_ = new QPushButton(tr("Validate"), this);
+  statusLabel_ = new QLabel(this);
+  resultsTable_ = new QTableView(this);
+
+  resultsModel_ = new ValidationResultModel(this);
+  sortModel_ = new QSortFilterProxyModel(this);
+  sortModel_->setSourceModel(resultsModel_);
+  resultsTable_->setModel(sortModel_);
+  resultsTable_->setSortingEnabled(true);
+  resultsTable_->sortByColumn(ValidationResultModel::VRM_Face,
+                              Qt::AscendingOrder);
+
+  auto header = resultsTable_->verticalHeader();
+  // This forces the minimum size to be used.
+  header->setDefaultSectionSize(0);
+  header->setSectionResizeMode(QHeaderView::Fixed);
+  resultsTable_->horizontalHeader()->setStretchLastSection(true);
+
+  // Tooltips
+  validateButton_->setToolTip(tr(
+    "Validate all faces of the current font file with FreeType's\n"
+    "OpenType and TrueTypeGX/AAT validators, in parallel.\n"
+    "The table directory checks of the 'SFNT' tab are included."));
+
+  // Layouting
+  buttonLayout_ = new QHBoxLayout;
+  buttonLayout_->addWidget(validateButton_);
+  buttonLayout_->addWidget(statusLabel_);
+  buttonLayout_->addStretch(1);
+
+  mainLayout_ = new QVBoxLayout;
+  mainLayout_->addLayout(buttonLayout_);
+  mainLayout_->addWidget(resultsTable_);
+
+  setLayout(mainLayout_);
+}
+
+
+void
+ValidationTab::createConnections()
+{
+  connect(validateButton_, &QPushButton::clicked,
+          this, &ValidationTab::validateOrCancel);
+  connect(validator_, &FontValidator::progress,
+          this, &ValidationTab::updateProgress);
+  connect(validator_, &FontValidator::finished,
+          this, &ValidationTab::showResults);
+}
+
+
+void
+ValidationTab::validateOrCancel()
+{
+  if (validator_->running())
+  {
+    validator_->cancel();
+    validateButton_->setText(tr("Validate"));
+    statusLabel_->setText(tr("Cancelled."));
+    return;
+  }
+
+  auto index = engine_->currentFontIndex();
+  auto& mgr = engine_->fontFileManager();
+  if (index < 0 || index >= mgr.size())
+    return;
+
+  clearResults();
+  validatedFontIndex_ = index;
+  validateButton_->setText(tr("Cancel"));
+
+  validator_->validate(mgr[index].filePath(),
+                       engine_->numberOfFaces(index),
+                       engine_->currentFontSFNTTableInfo());
+}
+
+
+void
+ValidationTab::clearResults()
+{
+  validator_->cancel();
+  validatedFontIndex_ = -1;
+  validateButton_->setText(tr("Validate"));
+  statusLabel_->clear();
+
+  resultsModel_->beginModelUpdate();
+  resultsModel_->storage().clear();
+  resultsModel_->endModelUpdate();
+}
+
+
+void
+ValidationTab::updateProgress(int finishedFaces,
+                              int totalFaces)
+{
+  statusLabel_->setText(tr("Validating: %1 of %2 faces done...")
+                          .arg(finishedFaces)
+                          .arg(totalFaces));
+}
+
+
+void
+ValidationTab::showResults()
+{
+  validateButton_->setText(tr("Validate"));
+
+  resultsModel_->beginModelUpdate();
+  resultsModel_->storage() = validator_->results();
+  resultsModel_->endModelUpdate();
+
+  auto problems = 0;
+  for (auto& result : resultsModel_->storage())
+    if (result.error)
+      problems++;
+
+  if (problems)
+    statusLabel_->setText(tr("%n problem(s) found.", "", problems));
+  else
+    statusLabel_->setText(tr("No problems found."));
+}
+
 // end of info.cpp
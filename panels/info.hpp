@@ -7,6 +7,7 @@
 
 #include "abstracttab.hpp"
 #include "../engine/fontinfo.hpp"
+#include "../engine/fontvalidator.hpp"
 #include "../models/fontinfomodels.hpp"
 #include "../widgets/customwidgets.hpp"
 
@@ -17,6 +18,8 @@
 #include <QGridLayout>
 #include <QGroupBox>
 #include <QLabel>
+#include <QPushButton>
+#include <QSortFilterProxyModel>
 #include <QTableView>
 #include <QTabWidget>
 #include <QTextEdit>
@@ -30,6 +33,7 @@ class SFNTInfoTab;
 class PostScriptInfoTab;
 class MMGXInfoTab;
 class CompositeGlyphsTab;
+class ValidationTab;
 
 class InfoTab
 : public QWidget,
@@ -57,6 +61,7 @@ private:
   PostScriptInfoTab* postScriptTab_;
   MMGXInfoTab* mmgxTab_;
   CompositeGlyphsTab* compositeGlyphsTab_;
+  ValidationTab* validationTab_;
 
   QTabWidget* tab_;
   QHBoxLayout* layout_;
@@ -345,4 +350,44 @@ private:
 };
 
 
+
+class ValidationTab
+: public QWidget,
+  public AbstractTab
+{
+  Q_OBJECT
+
+public:
+  ValidationTab(QWidget* parent,
+                Engine* engine);
+  ~ValidationTab() override = default;
+
+  void repaintGlyph() override {}
+  void reloadFont() override;
+
+private:
+  Engine* engine_;
+  int validatedFontIndex_ = -1;
+
+  FontValidator* validator_;
+
+  QPushButton* validateButton_;
+  QLabel* statusLabel_;
+  QTableView* resultsTable_;
+  ValidationResultModel* resultsModel_;
+  QSortFilterProxyModel* sortModel_;
+
+  QHBoxLayout* buttonLayout_;
+  QVBoxLayout* mainLayout_;
+
+  void createLayout();
+  void createConnections();
+
+  void validateOrCancel();
+  void clearResults();
+  void updateProgress(int finishedFaces,
+                      int totalFaces);
+  void showResults();
+};
+
 // end of info.hpp
@@ -220,7 +220,7 @@ SettingPanel::openBackgroundPicker()
   {
     backgroundColor_ = result;
     resetColorBlocks();
-    emit repaintNeeded();
+    emit recolorNeeded();
   }
 }
 
@@ -236,7 +236,7 @@ SettingPanel::openForegroundPicker()
   {
     foregroundColor_ = result;
     resetColorBlocks();
-    emit repaintNeeded();
+    emit recolorNeeded();
   }
 }
 
@@ -247,7 +247,7 @@ SettingPanel::updateGamma()
   gammaValueLabel_->setText(QString::number(gammaSlider_->value() / 10.0,
                             'f',
                             1));
-  emit repaintNeeded();
+  emit recolorNeeded();
 }
 
 
@@ -426,6 +426,7 @@ SettingPanel::applyDelayedSettings()
   }
 
   engine_->setStemDarkening(stemDarkeningCheckBox_->isChecked());
+  engine_->setComponentCache(componentCacheCheckBox_->isChecked());
 }
 
 
@@ -444,6 +445,7 @@ SettingPanel::createLayout()
 
   autoHintingCheckBox_ = new QCheckBox(tr("Auto-Hinting"), this);
   stemDarkeningCheckBox_ = new QCheckBox(tr("Stem Darkening"), this);
+  componentCacheCheckBox_ = new QCheckBox(tr("Component Cache"), this);
 
   if (debugMode_)
   {
@@ -539,6 +541,9 @@ SettingPanel::createLayout()
   stemDarkeningCheckBox_->setToolTip(tr(
     "Enable stem darkening (only valid for auto-hinter with gamma"
     " correction enabled and with Light AA modes)."));
+  componentCacheCheckBox_->setToolTip(tr(
+    "Reuse hinted components of TrueType composite glyphs (faster, but"
+    " cached components are not re-hinted and may render differently)."));
   gammaSlider_->setToolTip("Gamma correction value.");
   colorLayerCheckBox_->setToolTip(tr("Enable color layer rendering."));
   paletteComboBox_->setToolTip(tr(
@@ -619,6 +624,7 @@ SettingPanel::createLayoutNormal()
   gridLayout2ColAddLayout(generalTabLayout_, colorPickerLayout_);
   gridLayout2ColAddLayout(generalTabLayout_, gammaLayout_);
   gridLayout2ColAddWidget(generalTabLayout_, stemDarkeningCheckBox_);
+  gridLayout2ColAddWidget(generalTabLayout_, componentCacheCheckBox_);
   gridLayout2ColAddWidget(generalTabLayout_, embeddedBitmapCheckBox_);
   gridLayout2ColAddWidget(generalTabLayout_, colorLayerCheckBox_);
   gridLayout2ColAddWidget(generalTabLayout_,
@@ -663,6 +669,7 @@ SettingPanel::createLayoutComparator()
 
   gridLayout2ColAddLayout(hintingRenderingTabLayout_, gammaLayout_);
   gridLayout2ColAddWidget(hintingRenderingTabLayout_, stemDarkeningCheckBox_);
+  gridLayout2ColAddWidget(hintingRenderingTabLayout_, componentCacheCheckBox_);
 
   // General
   gridLayout2ColAddLayout(generalTabLayout_, colorPickerLayout_);
@@ -702,9 +709,11 @@ SettingPanel::createConnections()
   connect(lcdFilterComboBox_,
           QOverload<int>::of(&QComboBox::currentIndexChanged),
           this, &SettingPanel::repaintNeeded);
+  // Palettes are applied when compositing color layers, so there is no need
+  // to reset the glyph cache.
   connect(paletteComboBox_,
           QOverload<int>::of(&QComboBox::currentIndexChanged),
-          this, &SettingPanel::checkPalette);
+          this, &SettingPanel::repaintNeeded);
 
   connect(gammaSlider_, &QSlider::valueChanged,
           this, &SettingPanel::updateGamma);
@@ -730,6 +739,8 @@ SettingPanel::createConnections()
           this, &SettingPanel::fontReloadNeeded);
   connect(stemDarkeningCheckBox_, &QCheckBox::clicked,
           this, &SettingPanel::fontReloadNeeded);
+  connect(componentCacheCheckBox_, &QCheckBox::clicked,
+          this, &SettingPanel::fontReloadNeeded);
   connect(colorLayerCheckBox_, &QCheckBox::clicked,
           this, &SettingPanel::checkPalette);
 
@@ -786,6 +797,7 @@ SettingPanel::setDefaults()
   }
 
   embeddedBitmapCheckBox_->setChecked(false);
+  componentCacheCheckBox_->setChecked(false);
   colorLayerCheckBox_->setChecked(true);
   paletteComboBox_->setEnabled(false);
 
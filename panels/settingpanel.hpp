@@ -46,6 +46,7 @@ public:
 signals:
   void fontReloadNeeded();
   void repaintNeeded();
+  void recolorNeeded(); // Only colors or gamma changed.
 
 private:
   Engine* engine_;
@@ -84,6 +85,7 @@ private:
   QCheckBox* segmentDrawingCheckBox_;
   QCheckBox* autoHintingCheckBox_;
   QCheckBox* stemDarkeningCheckBox_;
+  QCheckBox* componentCacheCheckBox_;
   QCheckBox* embeddedBitmapCheckBox_;
   QCheckBox* colorLayerCheckBox_;
   QCheckBox* kerningCheckBox_;
@@ -50,6 +50,21 @@ SingularTab::setGlyphIndex(int index)
 }
 
 
+void
+SingularTab::goToGlyphName()
+{
+  auto index = engine_->glyphIndexFromName(glyphNameEdit_->text().trimmed());
+  if (index < 0)
+  {
+    glyphNameEdit_->setStyleSheet("QLineEdit { color : red; }");
+    return;
+  }
+
+  glyphNameEdit_->setStyleSheet("");
+  indexSelector_->setCurrentIndex(index);
+}
+
+
 void
 SingularTab::drawGlyph()
 {
@@ -96,6 +111,7 @@ SingularTab::drawGlyph()
   applySettings();
   engine_->loadPalette();
   FT_Glyph glyph = engine_->loadGlyph(currentGlyphIndex_);
+  glyphErrorLabel_->setText(engine_->glyphError(currentGlyphIndex_));
   if (glyph)
   {
     if (showBitmapCheckBox_->isChecked())
@@ -145,6 +161,53 @@ SingularTab::drawGlyph()
     gridItem_->updateParameters(0, 0, 0);
 
   glyphScene_->update();
+  updatePpemSweep();
+}
+
+
+void
+SingularTab::changeSize()
+{
+  // Unlike `repaintGlyph` this keeps the ppem sweep cache.
+  zoom();
+  drawGlyph();
+}
+
+
+void
+SingularTab::updatePpemSweep()
+{
+  if (!showPpemSweepCheckBox_->isChecked() || currentGlyphCount_ <= 0)
+  {
+    ppemSweepScrollArea_->hide();
+    return;
+  }
+
+  ppemSweep_->setRange(ppemSweepFirstSpinBox_->value(),
+                       ppemSweepLastSpinBox_->value());
+  // `drawGlyph` has reloaded the font with the current settings.  If the
+  // glyph isn't rendered yet, keep the old images until `finished` calls
+  // us again.
+  auto& images = ppemSweep_->render(currentGlyphIndex_);
+  if (!images.empty())
+    ppemStrip_->setImages(images);
+  if (engine_->currentFtSize())
+    ppemStrip_->setCurrentPpem(engine_->currentFontMetrics().y_ppem);
+  ppemStrip_->setBackground(
+    QColor(engine_->renderingEngine()->background()));
+
+  ppemSweepScrollArea_->setFixedHeight(
+    ppemStrip_->height()
+    + ppemSweepScrollArea_->horizontalScrollBar()->sizeHint().height()
+    + 2 * ppemSweepScrollArea_->frameWidth());
+  ppemSweepScrollArea_->show();
+}
+
+
+void
+SingularTab::setSizeFromSweep(int ppem)
+{
+  sizeSelector_->setSizePixel(ppem); // This auto-triggers update.
 }
 
 
@@ -325,11 +388,22 @@ SingularTab::createLayout()
   glyphIndexLabel_->setStyleSheet("QLabel { color : black; }");
   glyphNameLabel_->setStyleSheet("QLabel { color : black; }");
 
+  // Set if the glyph exceeded the engine's budgets.
+  glyphErrorLabel_ = new QLabel(glyphView_);
+  glyphErrorLabel_->setFont(overlayFont);
+  glyphErrorLabel_->setSizePolicy(QSizePolicy::Minimum, QSizePolicy::Minimum);
+  glyphErrorLabel_->setAttribute(Qt::WA_TransparentForMouseEvents, true);
+  glyphErrorLabel_->setStyleSheet("QLabel { color : red; }");
+
   indexSelector_ = new GlyphIndexSelector(this);
   indexSelector_->setSingleMode(true);
 
   sizeSelector_ = new FontSizeSelector(this, false, false);
 
+  glyphNameEdit_ = new QLineEdit(this);
+  glyphNameEdit_->setPlaceholderText(tr("Glyph Name"));
+  glyphNameEdit_->setClearButtonEnabled(true);
+
   centerGridButton_ = new QPushButton("Go Back to Grid Center", this);
   helpButton_ = new QPushButton("?", this);
   helpButton_->setSizePolicy(QSizePolicy::Maximum, QSizePolicy::Maximum);
@@ -340,6 +414,22 @@ SingularTab::createLayout()
   showOutlinesCheckBox_ = new QCheckBox(tr("Show Outlines"), this);
   showGridCheckBox_ = new QCheckBox(tr("Show Grid"), this);
   showAuxLinesCheckBox_ = new QCheckBox(tr("Show Aux. Lines"), this);
+  showPpemSweepCheckBox_ = new QCheckBox(tr("Show ppem Sweep"), this);
+
+  ppemSweepLabel_ = new QLabel(tr("Sweep Range (px):"), this);
+  ppemSweepFirstSpinBox_ = new QSpinBox(this);
+  ppemSweepLastSpinBox_ = new QSpinBox(this);
+  ppemSweepFirstSpinBox_->setRange(1, 500);
+  ppemSweepLastSpinBox_->setRange(1, 500);
+
+  ppemStrip_ = new PpemStrip(this);
+  ppemSweep_ = new PpemSweep(this, engine_, engine_->renderScheduler());
+  ppemSweepScrollArea_ = new QScrollArea(this);
+  ppemSweepScrollArea_->setWidget(ppemStrip_);
+  ppemSweepScrollArea_->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+  ppemSweepScrollArea_->setHorizontalScrollBarPolicy(
+    Qt::ScrollBarAlwaysOn);
+  ppemSweepScrollArea_->hide();
 
   // Tooltips
   centerGridButton_->setToolTip(tr(
@@ -354,11 +444,21 @@ SingularTab::createLayout()
   showGridCheckBox_->setToolTip(tr("Show grid lines (x axis: baseline)."));
   showBitmapCheckBox_->setToolTip(tr(
     "Show auxiliary lines (blue: y-advance; red: ascender/descender)."));
+  glyphNameEdit_->setToolTip(tr(
+    "Enter a glyph name and press Enter to jump to that glyph\n"
+    "(only available for fonts with glyph names)."));
   helpButton_->setToolTip(tr("View scroll help"));
+  showPpemSweepCheckBox_->setToolTip(tr(
+    "Show the current glyph at every pixel size of the sweep range\n"
+    "below the grid view (useful to find hinting problems that\n"
+    "only occur at certain sizes)."));
+  ppemSweepFirstSpinBox_->setToolTip(tr("First ppem of the sweep"));
+  ppemSweepLastSpinBox_->setToolTip(tr("Last ppem of the sweep"));
 
   // Layouting
   indexHelpLayout_ = new QHBoxLayout;
   indexHelpLayout_->addWidget(indexSelector_, 1);
+  indexHelpLayout_->addWidget(glyphNameEdit_);
   indexHelpLayout_->addWidget(helpButton_);
 
   sizeLayout_ = new QHBoxLayout;
@@ -377,20 +477,32 @@ SingularTab::createLayout()
   checkBoxesLayout_->addWidget(showGridCheckBox_);
   checkBoxesLayout_->addWidget(showAuxLinesCheckBox_);
 
+  ppemSweepLayout_ = new QHBoxLayout;
+  ppemSweepLayout_->addStretch(1);
+  ppemSweepLayout_->addWidget(showPpemSweepCheckBox_);
+  ppemSweepLayout_->addWidget(ppemSweepLabel_);
+  ppemSweepLayout_->addWidget(ppemSweepFirstSpinBox_);
+  ppemSweepLayout_->addWidget(ppemSweepLastSpinBox_);
+  ppemSweepLayout_->addStretch(1);
+
   glyphOverlayIndexLayout_ = new QHBoxLayout;
   glyphOverlayIndexLayout_->addWidget(glyphIndexLabel_);
   glyphOverlayIndexLayout_->addWidget(glyphNameLabel_);
   glyphOverlayLayout_ = new QGridLayout; // Use a grid layout to align.
   glyphOverlayLayout_->addLayout(glyphOverlayIndexLayout_, 0, 1,
                                  Qt::AlignTop | Qt::AlignRight);
+  glyphOverlayLayout_->addWidget(glyphErrorLabel_, 1, 0, 1, 2,
+                                 Qt::AlignBottom | Qt::AlignLeft);
   glyphView_->setLayout(glyphOverlayLayout_);
 
   mainLayout_ = new QVBoxLayout;
   mainLayout_->addWidget(glyphView_);
+  mainLayout_->addWidget(ppemSweepScrollArea_);
   mainLayout_->addLayout(indexHelpLayout_);
   mainLayout_->addSpacing(10);
   mainLayout_->addLayout(sizeLayout_);
   mainLayout_->addLayout(checkBoxesLayout_);
+  mainLayout_->addLayout(ppemSweepLayout_);
   mainLayout_->addSpacing(10);
 
   setLayout(mainLayout_);
@@ -401,9 +513,13 @@ void
 SingularTab::createConnections()
 {
   connect(sizeSelector_, &FontSizeSelector::valueChanged,
-          this, &SingularTab::repaintGlyph);
+          this, &SingularTab::changeSize);
   connect(indexSelector_, &GlyphIndexSelector::currentIndexChanged,
           this, &SingularTab::setGlyphIndex);
+  connect(glyphNameEdit_, &QLineEdit::returnPressed,
+          this, &SingularTab::goToGlyphName);
+  connect(glyphNameEdit_, &QLineEdit::textEdited,
+          [this] { glyphNameEdit_->setStyleSheet(""); });
 
   connect(glyphView_, &QGraphicsViewx::shiftWheelEvent,
           this, &SingularTab::wheelResize);
@@ -432,6 +548,17 @@ SingularTab::createConnections()
           this, &SingularTab::setGridVisible);
   connect(showAuxLinesCheckBox_, &QCheckBox::clicked,
           this, &SingularTab::setGridVisible);
+  // `drawGlyph` calls `updatePpemSweep` after reloading the font.
+  connect(showPpemSweepCheckBox_, &QCheckBox::clicked,
+          this, &SingularTab::drawGlyph);
+  connect(ppemSweepFirstSpinBox_, QOverload<int>::of(&QSpinBox::valueChanged),
+          this, &SingularTab::drawGlyph);
+  connect(ppemSweepLastSpinBox_, QOverload<int>::of(&QSpinBox::valueChanged),
+          this, &SingularTab::drawGlyph);
+  connect(ppemStrip_, &PpemStrip::ppemClicked,
+          this, &SingularTab::setSizeFromSweep);
+  connect(ppemSweep_, &PpemSweep::finished,
+          this, &SingularTab::updatePpemSweep);
 
   sizeSelector_->installEventFilterForWidget(glyphView_);
   sizeSelector_->installEventFilterForWidget(this);
@@ -441,6 +568,7 @@ SingularTab::createConnections()
 void
 SingularTab::repaintGlyph()
 {
+  ppemSweep_->clear(); // Settings have changed.
   zoom();
   drawGlyph();
 }
@@ -455,6 +583,7 @@ SingularTab::reloadFont()
     QSignalBlocker blocker(sizeSelector_);
     sizeSelector_->reloadFromFont(engine_);
   }
+  ppemSweep_->clear();
   drawGlyph();
 }
 
@@ -494,6 +623,9 @@ SingularTab::setDefaults()
   showAuxLinesCheckBox_->setChecked(true);
   gridItem_->setShowGrid(true, true);
 
+  ppemSweepFirstSpinBox_->setValue(6);
+  ppemSweepLastSpinBox_->setValue(72);
+
   indexSelector_->setCurrentIndex(indexSelector_->currentIndex(), true);
   zoom();
 }
@@ -7,12 +7,14 @@
 
 #include "abstracttab.hpp"
 #include "../engine/engine.hpp"
+#include "../engine/ppemsweep.hpp"
 #include "../glyphcomponents/glyphbitmap.hpp"
 #include "../glyphcomponents/glyphoutline.hpp"
 #include "../glyphcomponents/glyphpointnumbers.hpp"
 #include "../glyphcomponents/glyphpoints.hpp"
 #include "../glyphcomponents/graphicsdefault.hpp"
 #include "../glyphcomponents/grid.hpp"
+#include "../glyphcomponents/ppemstrip.hpp"
 #include "../models/customcomboboxmodels.hpp"
 #include "../widgets/customwidgets.hpp"
 #include "../widgets/glyphindexselector.hpp"
@@ -25,8 +27,10 @@
 #include <QGraphicsView>
 #include <QGridLayout>
 #include <QLabel>
+#include <QLineEdit>
 #include <QPen>
 #include <QPushButton>
+#include <QScrollArea>
 #include <QScrollBar>
 #include <QSpinBox>
 #include <QVector>
@@ -53,7 +57,11 @@ public:
 
 private slots:
   void setGlyphIndex(int);
+  void goToGlyphName();
   void drawGlyph();
+  void changeSize();
+  void updatePpemSweep();
+  void setSizeFromSweep(int ppem);
 
   void checkShowPoints();
 
@@ -74,6 +82,7 @@ private:
   int currentGlyphCount_ = 0;
 
   Engine* engine_;
+  PpemSweep* ppemSweep_;
 
   QGraphicsScene* glyphScene_;
   QGraphicsViewx* glyphView_;
@@ -86,11 +95,13 @@ private:
 
   GlyphIndexSelector* indexSelector_;
   FontSizeSelector* sizeSelector_;
+  QLineEdit* glyphNameEdit_;
   QPushButton* centerGridButton_;
   QPushButton* helpButton_;
 
   QLabel* glyphIndexLabel_;
   QLabel* glyphNameLabel_;
+  QLabel* glyphErrorLabel_;
 
   QCheckBox* showBitmapCheckBox_;
   QCheckBox* showOutlinesCheckBox_;
@@ -98,11 +109,19 @@ private:
   QCheckBox* showPointsCheckBox_;
   QCheckBox* showGridCheckBox_;
   QCheckBox* showAuxLinesCheckBox_;
+  QCheckBox* showPpemSweepCheckBox_;
+
+  QLabel* ppemSweepLabel_;
+  QSpinBox* ppemSweepFirstSpinBox_;
+  QSpinBox* ppemSweepLastSpinBox_;
+  QScrollArea* ppemSweepScrollArea_;
+  PpemStrip* ppemStrip_;
 
   QVBoxLayout* mainLayout_;
   QHBoxLayout* checkBoxesLayout_;
   QHBoxLayout* indexHelpLayout_;
   QHBoxLayout* sizeLayout_;
+  QHBoxLayout* ppemSweepLayout_;
   QGridLayout* glyphOverlayLayout_;
   QHBoxLayout* glyphOverlayIndexLayout_;
 
@@ -0,0 +1,613 @@
+// sessionrecorder.cpp
+
+// Copyright (C) 2022-2023 by
+// Charlie Jiang.
+
+#include "sessionrecorder.hpp"
+
+#include <algorithm>
+
+#include <QAbstractButton>
+#include <QAbstractSlider>
+#include <QComboBox>
+#include <QCoreApplication>
+#include <QDoubleSpinBox>
+#include <QFile>
+#include <QJsonDocument>
+#include <QLineEdit>
+#include <QPlainTextEdit>
+#include <QScrollBar>
+#include <QSpinBox>
+#include <QTabBar>
+#include <QTabWidget>
+#include <QThread>
+#include <QTimer>
+
+
+namespace
+{
+
+// In milliseconds; longer than any debounce delay in the GUI.
+constexpr int QuietPeriod = 500;
+// Don't wait forever for, e.g., progress reports of background work.
+constexpr int MaxSettleTime = 10000;
+
+
+// Programmatic changes (e.g., a size spin box updated after a triplet
+// change) happen while the user interacts with some other widget.  Combo
+// boxes, buttons, line edits, and tab bars have signals for user
+// interaction only; the other widgets need this check.
+bool
+changedByUser(QWidget* widget)
+{
+  return widget->hasFocus() || widget->underMouse();
+}
+
+
+// Note the time of the last event delivered in the GUI thread.  Timer
+// events of widgets' internal timers (e.g., for cursor blinking) recur on
+// their own and are thus ignored; debouncing is done with `QTimer`.
+class ActivityWatcher
+: public QObject
+{
+public:
+  ActivityWatcher(QElapsedTimer const& timer)
+  : timer_(timer),
+    lastActivity_(timer.nsecsElapsed())
+  {
+    QCoreApplication::instance()->installEventFilter(this);
+  }
+
+
+  ~ActivityWatcher() override
+  {
+    QCoreApplication::instance()->removeEventFilter(this);
+  }
+
+
+  qint64 lastActivity() { return lastActivity_; }
+
+
+  bool
+  eventFilter(QObject* watched,
+              QEvent* event) override
+  {
+    if (event->type() != QEvent::Timer || qobject_cast<QTimer*>(watched))
+      lastActivity_ = timer_.nsecsElapsed();
+    return false;
+  }
+
+private:
+  QElapsedTimer const& timer_;
+  qint64 lastActivity_;
+};
+
+
+// Return the latency in nanoseconds.
+qint64
+settle(QElapsedTimer const& timer,
+       ActivityWatcher& watcher)
+{
+  // Layouting, painting, and debounced work (pending timers and the
+  // events they cause in turn) are all processed here.
+  auto quietPeriod = static_cast<qint64>(QuietPeriod) * 1000000;
+  auto maxSettleTime = static_cast<qint64>(MaxSettleTime) * 1000000;
+  for (;;)
+  {
+    QCoreApplication::processEvents();
+
+    auto now = timer.nsecsElapsed();
+    if (now - watcher.lastActivity() >= quietPeriod || now >= maxSettleTime)
+      break;
+    QThread::msleep(1);
+  }
+  return watcher.lastActivity();
+}
+
+} // namespace
+
+
+SessionRecorder::SessionRecorder(QWidget* root)
+: QObject(root),
+  root_(root)
+{
+}
+
+
+void
+SessionRecorder::start(QStringList const& openFonts)
+{
+  stop();
+
+  state_ = QJsonArray();
+  actions_ = QJsonArray();
+  state_.append(QJsonObject{
+    { "type", "open" },
+    { "files", QJsonArray::fromStringList(openFonts) } });
+  for (auto widget : inputWidgets())
+  {
+    auto action = snapshot(widget);
+    if (!action.isEmpty())
+      state_.append(action);
+
+    if (auto combo = qobject_cast<QComboBox*>(widget))
+      connections_.push_back(
+        connect(combo, QOverload<int>::of(&QComboBox::activated),
+                this,
+                [this, combo](int index)
+                {
+                  record(combo, "combo", index);
+                }));
+    else if (auto button = qobject_cast<QAbstractButton*>(widget))
+      connections_.push_back(
+        connect(button, &QAbstractButton::clicked,
+                this,
+                [this, button](bool checked)
+                {
+                  record(button, "button",
+                         button->isCheckable() ? QJsonValue(checked)
+                                               : QJsonValue());
+                }));
+    else if (auto spinBox = qobject_cast<QSpinBox*>(widget))
+      connections_.push_back(
+        connect(spinBox, QOverload<int>::of(&QSpinBox::valueChanged),
+                this,
+                [this, spinBox](int value)
+                {
+                  if (changedByUser(spinBox))
+                    record(spinBox, "spin", value);
+                }));
+    else if (auto doubleSpinBox = qobject_cast<QDoubleSpinBox*>(widget))
+      connections_.push_back(
+        connect(doubleSpinBox,
+                QOverload<double>::of(&QDoubleSpinBox::valueChanged),
+                this,
+                [this, doubleSpinBox](double value)
+                {
+                  if (changedByUser(doubleSpinBox))
+                    record(doubleSpinBox, "doubleSpin", value);
+                }));
+    else if (auto slider = qobject_cast<QAbstractSlider*>(widget))
+      connections_.push_back(
+        connect(slider, &QAbstractSlider::valueChanged,
+                this,
+                [this, slider](int value)
+                {
+                  if (changedByUser(slider))
+                    record(slider, "slider", value);
+                }));
+    else if (auto lineEdit = qobject_cast<QLineEdit*>(widget))
+      connections_.push_back(
+        connect(lineEdit, &QLineEdit::textEdited,
+                this,
+                [this, lineEdit](QString const& text)
+                {
+                  record(lineEdit, "lineEdit", text);
+                }));
+    else if (auto textEdit = qobject_cast<QPlainTextEdit*>(widget))
+      connections_.push_back(
+        connect(textEdit, &QPlainTextEdit::textChanged,
+                this,
+                [this, textEdit]
+                {
+                  if (changedByUser(textEdit))
+                    record(textEdit, "textEdit", textEdit->toPlainText());
+                }));
+    else if (auto tabWidget = qobject_cast<QTabWidget*>(widget))
+      connections_.push_back(
+        connect(tabWidget, &QTabWidget::tabBarClicked,
+                this,
+                [this, tabWidget](int index)
+                {
+                  record(tabWidget, "tab", index);
+                }));
+  }
+
+  recording_ = true;
+  clock_.start();
+}
+
+
+void
+SessionRecorder::stop()
+{
+  for (auto& connection : connections_)
+    disconnect(connection);
+  connections_.clear();
+  recording_ = false;
+}
+
+
+bool
+SessionRecorder::save(QString const& filePath)
+{
+  QFile file(filePath);
+  if (!file.open(QIODevice::WriteOnly))
+    return false;
+
+  QJsonObject trace{ { "version", 1 },
+                     { "state", state_ },
+                     { "actions", actions_ } };
+  return file.write(QJsonDocument(trace).toJson()) >= 0;
+}
+
+
+void
+SessionRecorder::recordFontsOpened(QStringList const& fileNames)
+{
+  if (!recording_)
+    return;
+
+  actions_.append(QJsonObject{
+    { "time", static_cast<double>(clock_.elapsed()) },
+    { "type", "open" },
+    { "files", QJsonArray::fromStringList(fileNames) } });
+}
+
+
+std::vector<SessionRecorder::ReplayResult>
+SessionRecorder::replay(QString const& filePath,
+                        QString& error)
+{
+  QFile file(filePath);
+  if (!file.open(QIODevice::ReadOnly))
+  {
+    error = file.errorString();
+    return {};
+  }
+
+  QJsonParseError parseError;
+  auto document = QJsonDocument::fromJson(file.readAll(), &parseError);
+  if (!document.isObject())
+  {
+    error = parseError.errorString();
+    return {};
+  }
+  auto trace = document.object();
+
+  QCoreApplication::processEvents(); // Let the window settle first.
+  for (auto action : trace["state"].toArray())
+    apply(action.toObject());
+
+  std::vector<ReplayResult> results;
+  for (auto value : trace["actions"].toArray())
+  {
+    auto action = value.toObject();
+
+    // Deliver results of asynchronous work started by earlier actions so
+    // that they don't end up in the next action's time.
+    QCoreApplication::processEvents();
+
+    ReplayResult result;
+    result.type = action["type"].toString();
+    result.widget = action["widget"].toString();
+    result.recordedTime = static_cast<qint64>(action["time"].toDouble());
+
+    QElapsedTimer timer;
+    timer.start();
+    ActivityWatcher watcher(timer);
+    result.applied = apply(action);
+    result.latency = settle(timer, watcher) / 1e6;
+
+    results.push_back(result);
+  }
+
+  if (results.empty())
+    error = tr("The trace doesn't contain any actions.");
+  return results;
+}
+
+
+QString
+SessionRecorder::report(std::vector<ReplayResult> const& results)
+{
+  QString csv = "index,type,widget,recorded_ms,latency_ms,applied\n";
+  for (size_t i = 0; i < results.size(); i++)
+  {
+    auto& result = results[i];
+    csv += QString("%1,%2,%3,%4,%5,%6\n")
+             .arg(i)
+             .arg(result.type, result.widget)
+             .arg(result.recordedTime)
+             .arg(result.latency, 0, 'f', 3)
+             .arg(result.applied ? 1 : 0);
+  }
+  return csv;
+}
+
+
+QString
+SessionRecorder::summary(std::vector<ReplayResult> const& results)
+{
+  if (results.empty())
+    return tr("No actions replayed.");
+
+  std::vector<double> latencies;
+  double total = 0;
+  int missing = 0;
+  for (auto& result : results)
+  {
+    latencies.push_back(result.latency);
+    total += result.latency;
+    if (!result.applied)
+      missing++;
+  }
+
+  auto slowest = std::max_element(results.begin(), results.end(),
+                                  [](ReplayResult const& a,
+                                     ReplayResult const& b)
+                                  {
+                                    return a.latency < b.latency;
+                                  });
+  auto middle = latencies.begin() + latencies.size() / 2;
+  std::nth_element(latencies.begin(), middle, latencies.end());
+
+  auto text = tr("%n action(s) replayed in %1 ms.\n"
+                 "Median latency: %2 ms\n"
+                 "Slowest: %3 (%4) with %5 ms", "",
+                 static_cast<int>(results.size()))
+                .arg(total, 0, 'f', 1)
+                .arg(*middle, 0, 'f', 2)
+                .arg(slowest->type, slowest->widget)
+                .arg(slowest->latency, 0, 'f', 2);
+  if (missing)
+    text += tr("\n%n action(s) couldn't be applied"
+               " since their widget wasn't found.", "", missing);
+  return text;
+}
+
+
+std::vector<QWidget*>
+SessionRecorder::inputWidgets()
+{
+  std::vector<QWidget*> widgets;
+  for (auto widget : root_->findChildren<QWidget*>())
+  {
+    // Parts of other widgets, or view state only.
+    auto parent = widget->parentWidget();
+    if (qobject_cast<QAbstractSpinBox*>(parent)
+        || qobject_cast<QComboBox*>(parent)
+        || qobject_cast<QTabBar*>(parent)
+        || qobject_cast<QScrollBar*>(widget))
+      continue;
+
+    if (qobject_cast<QComboBox*>(widget)
+        || qobject_cast<QAbstractButton*>(widget)
+        || qobject_cast<QAbstractSpinBox*>(widget)
+        || qobject_cast<QAbstractSlider*>(widget)
+        || qobject_cast<QLineEdit*>(widget)
+        || qobject_cast<QPlainTextEdit*>(widget)
+        || qobject_cast<QTabWidget*>(widget))
+      widgets.push_back(widget);
+  }
+  return widgets;
+}
+
+
+// Something like `QWidget#0/QTabWidget#0/QStackedWidget#0/...`; an index
+// counts the preceding siblings of the same class.
+QString
+SessionRecorder::widgetPath(QWidget* widget)
+{
+  QStringList parts;
+  QObject* object = widget;
+  for (; object && object != root_; object = object->parent())
+  {
+    auto parent = object->parent();
+    if (!parent)
+      break;
+
+    int index = 0;
+    for (auto sibling : parent->children())
+    {
+      if (sibling == object)
+        break;
+      if (sibling->metaObject() == object->metaObject())
+        index++;
+    }
+    parts.prepend(QString("%1#%2").arg(object->metaObject()->className())
+                                   .arg(index));
+  }
+
+  if (object != root_)
+    return {};
+  return parts.join('/');
+}
+
+
+QWidget*
+SessionRecorder::findWidget(QString const& path)
+{
+  QObject* object = root_;
+  for (auto& part : path.split('/', Qt::SkipEmptyParts))
+  {
+    auto separator = part.lastIndexOf('#');
+    auto className = part.left(separator);
+    auto index = part.mid(separator + 1).toInt();
+
+    QObject* next = NULL;
+    for (auto child : object->children())
+    {
+      if (className != child->metaObject()->className())
+        continue;
+      if (index-- == 0)
+      {
+        next = child;
+        break;
+      }
+    }
+    if (!next)
+      return NULL;
+    object = next;
+  }
+
+  return object == root_ ? NULL : qobject_cast<QWidget*>(object);
+}
+
+
+QJsonObject
+SessionRecorder::snapshot(QWidget* widget)
+{
+  QString type;
+  QJsonValue value;
+  if (auto combo = qobject_cast<QComboBox*>(widget))
+  {
+    if (combo->currentIndex() < 0)
+      return {};
+    type = "combo";
+    value = combo->currentIndex();
+  }
+  else if (auto button = qobject_cast<QAbstractButton*>(widget))
+  {
+    if (!button->isCheckable())
+      return {};
+    type = "button";
+    value = button->isChecked();
+  }
+  else if (auto spinBox = qobject_cast<QSpinBox*>(widget))
+  {
+    type = "spin";
+    value = spinBox->value();
+  }
+  else if (auto doubleSpinBox = qobject_cast<QDoubleSpinBox*>(widget))
+  {
+    type = "doubleSpin";
+    value = doubleSpinBox->value();
+  }
+  else if (auto slider = qobject_cast<QAbstractSlider*>(widget))
+  {
+    type = "slider";
+    value = slider->value();
+  }
+  else if (auto lineEdit = qobject_cast<QLineEdit*>(widget))
+  {
+    type = "lineEdit";
+    value = lineEdit->text();
+  }
+  else if (auto textEdit = qobject_cast<QPlainTextEdit*>(widget))
+  {
+    type = "textEdit";
+    value = textEdit->toPlainText();
+  }
+  else if (auto tabWidget = qobject_cast<QTabWidget*>(widget))
+  {
+    type = "tab";
+    value = tabWidget->currentIndex();
+  }
+  else
+    return {};
+
+  auto path = widgetPath(widget);
+  if (path.isEmpty())
+    return {};
+  return { { "type", type }, { "widget", path }, { "value", value } };
+}
+
+
+void
+SessionRecorder::record(QWidget* widget,
+                        QString const& type,
+                        QJsonValue const& value)
+{
+  if (!recording_)
+    return;
+
+  auto path = widgetPath(widget);
+  if (path.isEmpty())
+    return;
+
+  actions_.append(QJsonObject{
+    { "time", static_cast<double>(clock_.elapsed()) },
+    { "type", type },
+    { "widget", path },
+    { "value", value } });
+}
+
+
+// The widgets' own signals are triggered the same way as for user input.
+bool
+SessionRecorder::apply(QJsonObject const& action)
+{
+  auto type = action["type"].toString();
+  if (type == "open")
+  {
+    QStringList fileNames;
+    for (auto fileName : action["files"].toArray())
+      fileNames.append(fileName.toString());
+    emit openFontsRequested(fileNames);
+    return true;
+  }
+
+  auto widget = findWidget(action["widget"].toString());
+  if (!widget)
+    return false;
+
+  auto value = action["value"];
+  if (type == "combo")
+  {
+    auto combo = qobject_cast<QComboBox*>(widget);
+    if (!combo || value.toInt() >= combo->count())
+      return false;
+    combo->setCurrentIndex(value.toInt());
+    emit combo->activated(value.toInt());
+  }
+  else if (type == "button")
+  {
+    auto button = qobject_cast<QAbstractButton*>(widget);
+    if (!button)
+      return false;
+    if (!button->isCheckable() || button->isChecked() != value.toBool())
+      button->click();
+  }
+  else if (type == "spin")
+  {
+    auto spinBox = qobject_cast<QSpinBox*>(widget);
+    if (!spinBox)
+      return false;
+    spinBox->setValue(value.toInt());
+  }
+  else if (type == "doubleSpin")
+  {
+    auto doubleSpinBox = qobject_cast<QDoubleSpinBox*>(widget);
+    if (!doubleSpinBox)
+      return false;
+    doubleSpinBox->setValue(value.toDouble());
+  }
+  else if (type == "slider")
+  {
+    auto slider = qobject_cast<QAbstractSlider*>(widget);
+    if (!slider)
+      return false;
+    slider->setValue(value.toInt());
+  }
+  else if (type == "lineEdit")
+  {
+    auto lineEdit = qobject_cast<QLineEdit*>(widget);
+    if (!lineEdit)
+      return false;
+    // Unlike `setText`, this emits `textEdited`.
+    lineEdit->selectAll();
+    lineEdit->insert(value.toString());
+  }
+  else if (type == "textEdit")
+  {
+    auto textEdit = qobject_cast<QPlainTextEdit*>(widget);
+    if (!textEdit)
+      return false;
+    textEdit->setPlainText(value.toString());
+  }
+  else if (type == "tab")
+  {
+    auto tabWidget = qobject_cast<QTabWidget*>(widget);
+    if (!tabWidget)
+      return false;
+    tabWidget->setCurrentIndex(value.toInt());
+  }
+  else
+    return false;
+
+  return true;
+}
+
+
+// end of sessionrecorder.cpp
@@ -0,0 +1,96 @@
+// sessionrecorder.hpp
+
+// Copyright (C) 2022-2023 by
+// Charlie Jiang.
+
+#pragma once
+
+#include <vector>
+
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QWidget>
+
+
+// Record what the user does in the main window as a trace of high-level
+// actions and replay it later, measuring how long each action takes.
+// Replaying the same trace before and after a change gives a benchmark of
+// real-world interaction.
+//
+// Actions are value changes of input widgets (combo boxes, buttons, spin
+// boxes, sliders, text fields, and tabs) plus opened font files.  This
+// covers triplet and setting changes, glyph navigation, and text edits
+// without touching every panel.  Widgets are identified by their path of
+// class names and indices in the object tree, which is stable for a given
+// build.  Only changes made by the user are recorded, not the ones these
+// cause programmatically.
+//
+// A trace also stores the widget state at the start of recording; it is
+// restored before replaying so that each replay starts alike.  Actions are
+// replayed back to back; after each one, events are processed until none
+// arrived for a period longer than any debounce delay.  An action's
+// latency is the time until the last of these events was delivered, thus
+// including layouting, painting, debounced updates, and asynchronous work
+// finishing meanwhile.
+class SessionRecorder
+: public QObject
+{
+  Q_OBJECT
+
+public:
+  struct ReplayResult
+  {
+    QString type;
+    QString widget;
+    qint64 recordedTime = 0; // Milliseconds since recording started.
+    double latency = 0; // Milliseconds.
+    bool applied = false; // `false` if the widget wasn't found.
+  };
+
+  SessionRecorder(QWidget* root);
+  ~SessionRecorder() override = default;
+
+  // `openFonts` are the font files opened at the start.
+  void start(QStringList const& openFonts);
+  void stop();
+  bool recording() { return recording_; }
+  bool save(QString const& filePath);
+  // Fonts can be opened without any widget involved.
+  void recordFontsOpened(QStringList const& fileNames);
+
+  // Return an empty list and set `error` if the trace can't be read.
+  std::vector<ReplayResult> replay(QString const& filePath,
+                                   QString& error);
+  // CSV, one line per action.
+  static QString report(std::vector<ReplayResult> const& results);
+  static QString summary(std::vector<ReplayResult> const& results);
+
+  constexpr static const char* ReplayArgument = "--replay";
+
+signals:
+  void openFontsRequested(QStringList const& fileNames);
+
+private:
+  QWidget* root_;
+  bool recording_ = false;
+  QElapsedTimer clock_;
+  QJsonArray state_;
+  QJsonArray actions_;
+  std::vector<QMetaObject::Connection> connections_;
+
+  std::vector<QWidget*> inputWidgets();
+  QString widgetPath(QWidget* widget);
+  QWidget* findWidget(QString const& path);
+  QJsonObject snapshot(QWidget* widget);
+  void record(QWidget* widget,
+              QString const& type,
+              QJsonValue const& value);
+  bool apply(QJsonObject const& action);
+};
+
+
+// end of sessionrecorder.hpp
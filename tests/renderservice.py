@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+#
+# Test the render service of ftinspect (`ftinspect --serve <socket>`).
+#
+# Usage: renderservice.py <ftinspect executable>
+#
+# The font to render with, which must be scalable, is taken from the
+# environment variable `FTINSPECT_TEST_FONT`; without it the test is
+# skipped.
+
+import base64
+import json
+import os
+import socket
+import subprocess
+import sys
+import tempfile
+import time
+
+
+SKIP = 77
+
+
+def png_bit_depth(data):
+  """Return the bit depth of a PNG image from its IHDR chunk."""
+  if data[:8] != b"\x89PNG\r\n\x1a\n" or data[12:16] != b"IHDR":
+    raise ValueError("not a PNG image")
+  return data[24]
+
+
+def connect(path, timeout):
+  deadline = time.monotonic() + timeout
+  while True:
+    try:
+      client = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+      client.connect(path)
+      return client
+    except OSError:
+      client.close()
+      if time.monotonic() > deadline:
+        raise
+      time.sleep(0.05)
+
+
+def request(client, reader, obj):
+  client.sendall((json.dumps(obj) + "\n").encode())
+  reply = json.loads(reader.readline())
+  if reply.get("id") != obj["id"]:
+    raise ValueError("unexpected reply {}".format(reply))
+  return reply
+
+
+def rendered_depth(client, reader, request_id, font, antialiasing):
+  reply = request(client, reader,
+                  { "id": request_id,
+                    "command": "render",
+                    "font": font,
+                    "size": 32,
+                    "hinting": True,
+                    "antialiasing": antialiasing,
+                    "text": "O" })
+  if not reply.get("ok"):
+    raise ValueError("request failed: {}".format(reply))
+  glyph = reply["glyphs"][0]
+  if "png" not in glyph:
+    raise ValueError("no image for {}".format(glyph))
+  return png_bit_depth(base64.b64decode(glyph["png"]))
+
+
+def main():
+  if len(sys.argv) != 2:
+    print("usage: renderservice.py <ftinspect executable>", file=sys.stderr)
+    return 2
+
+  font = os.environ.get("FTINSPECT_TEST_FONT")
+  if not font:
+    print("FTINSPECT_TEST_FONT not set; skipping")
+    return SKIP
+
+  with tempfile.TemporaryDirectory() as directory:
+    path = os.path.join(directory, "ftinspect.sock")
+    server = subprocess.Popen([sys.argv[1], "--serve", path])
+    try:
+      client = connect(path, 10)
+      reader = client.makefile("r")
+
+      mono = rendered_depth(client, reader, 1, font, False)
+      gray = rendered_depth(client, reader, 2, font, True)
+      client.close()
+    finally:
+      server.terminate()
+      server.wait()
+
+  if mono != 1:
+    print("antialiasing off: expected a 1-bit image, got {} bits"
+          .format(mono), file=sys.stderr)
+    return 1
+  if gray == 1:
+    print("antialiasing on: got a 1-bit image", file=sys.stderr)
+    return 1
+
+  print("ok")
+  return 0
+
+
+if __name__ == "__main__":
+  sys.exit(main())
@@ -0,0 +1,105 @@
+// glyphbudgetdialog.cpp
+
+// Copyright (C) 2022-2023 by
+// Charlie Jiang.
+
+#include "glyphbudgetdialog.hpp"
+#include "../engine/engine.hpp"
+#include "../uihelper.hpp"
+
+#include <QPushButton>
+
+
+GlyphBudgetDialog::GlyphBudgetDialog(QWidget* parent,
+                                     Engine* engine)
+: QDialog(parent),
+  engine_(engine)
+{
+  setWindowTitle(tr("Glyph Budgets"));
+  setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint);
+
+  createLayout();
+  createConnections();
+
+  timeSpinBox_->setValue(engine_->glyphTimeBudget());
+  opcodeSpinBox_->setValue(static_cast<int>(engine_->glyphOpcodeBudget()));
+}
+
+
+bool
+GlyphBudgetDialog::apply()
+{
+  auto time = timeSpinBox_->value();
+  auto opcodes = static_cast<unsigned long>(opcodeSpinBox_->value());
+  if (time == engine_->glyphTimeBudget()
+      && opcodes == engine_->glyphOpcodeBudget())
+    return false;
+
+  engine_->setGlyphBudgets(time, opcodes);
+  return true;
+}
+
+
+void
+GlyphBudgetDialog::createLayout()
+{
+  timeLabel_ = new QLabel(tr("Time per Glyph:"), this);
+  opcodeLabel_ = new QLabel(tr("Bytecode Instructions per Run:"), this);
+
+  timeSpinBox_ = new QSpinBox(this);
+  timeSpinBox_->setRange(0, 60000);
+  timeSpinBox_->setSingleStep(50);
+  timeSpinBox_->setSuffix(tr(" ms"));
+  timeSpinBox_->setSpecialValueText(tr("Unlimited"));
+
+  opcodeSpinBox_ = new QSpinBox(this);
+  opcodeSpinBox_->setRange(1000, 100000000);
+  opcodeSpinBox_->setSingleStep(100000);
+
+  buttonBox_ = new QDialogButtonBox(QDialogButtonBox::Ok
+                                    | QDialogButtonBox::Cancel
+                                    | QDialogButtonBox::RestoreDefaults,
+                                    this);
+
+  // Tooltips
+  timeSpinBox_->setToolTip(tr(
+    "Glyphs taking longer to load are shown as errors and not loaded again"
+    " for the current font and settings."));
+  opcodeSpinBox_->setToolTip(tr(
+    "Maximum number of instructions a TrueType bytecode program may"
+    " execute before it is aborted; glyphs whose hinting is aborted are"
+    " shown as errors."));
+
+  // Layouting
+  layout_ = new QGridLayout;
+  gridLayout2ColAddWidget(layout_, timeLabel_, timeSpinBox_);
+  gridLayout2ColAddWidget(layout_, opcodeLabel_, opcodeSpinBox_);
+  gridLayout2ColAddWidget(layout_, buttonBox_);
+
+  setLayout(layout_);
+}
+
+
+void
+GlyphBudgetDialog::createConnections()
+{
+  connect(buttonBox_, &QDialogButtonBox::accepted,
+          this, &QDialog::accept);
+  connect(buttonBox_, &QDialogButtonBox::rejected,
+          this, &QDialog::reject);
+  connect(buttonBox_->button(QDialogButtonBox::RestoreDefaults),
+          &QPushButton::clicked,
+          this, &GlyphBudgetDialog::setDefaults);
+}
+
+
+void
+GlyphBudgetDialog::setDefaults()
+{
+  timeSpinBox_->setValue(Engine::DefaultGlyphTimeBudget);
+  opcodeSpinBox_->setValue(
+    static_cast<int>(engine_->defaultGlyphOpcodeBudget()));
+}
+
+
+// end of glyphbudgetdialog.cpp
@@ -0,0 +1,48 @@
+// glyphbudgetdialog.hpp
+
+// Copyright (C) 2022-2023 by
+// Charlie Jiang.
+
+#pragma once
+
+#include <QDialog>
+#include <QDialogButtonBox>
+#include <QGridLayout>
+#include <QLabel>
+#include <QSpinBox>
+
+
+class Engine;
+
+// Edit the engine's per-glyph time and instruction budgets.
+class GlyphBudgetDialog
+: public QDialog
+{
+  Q_OBJECT
+
+public:
+  GlyphBudgetDialog(QWidget* parent,
+                    Engine* engine);
+  ~GlyphBudgetDialog() override = default;
+
+  // Apply the budgets to the engine; return `false` if nothing changed.
+  bool apply();
+
+private:
+  Engine* engine_;
+
+  QLabel* timeLabel_;
+  QLabel* opcodeLabel_;
+  QSpinBox* timeSpinBox_;
+  QSpinBox* opcodeSpinBox_;
+  QDialogButtonBox* buttonBox_;
+
+  QGridLayout* layout_;
+
+  void createLayout();
+  void createConnections();
+  void setDefaults();
+};
+
+
+// end of glyphbudgetdialog.hpp